@@ -0,0 +1,289 @@
+/*
+ * ESP32-CAM 連拍 (Burst Capture)
+ *
+ * 暫存區只在啟動時配置一次，影格依序緊密存放，索引表為靜態陣列。
+ * 第一張影格以時間戳記選出 (開始時間晚於請求)，不需清除舊影格。
+ * tar 封存的檔案時間只有秒精度，因此另附 timestamps.csv。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include <esp_log.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_camera.h"
+
+#include "burst.h"
+#include "frame_stamp.h"
+#include "idle_mgr.h"
+
+static const char *TAG = "burst";
+
+#define BURST_BOUNDARY          "burst-frame-boundary-2f9c1e"
+#define BURST_JITTER_US         5000    // Tolerance when matching the requested interval
+#define BURST_MAX_SKIP_FRAMES   64
+#define BURST_WAKE_EARLY_US     200000  // Resume grabbing this long before the next frame is due
+#define TAR_BLOCK               512
+
+typedef struct {
+    uint32_t offset;
+    uint32_t len;
+    uint16_t width;
+    uint16_t height;
+    pixformat_t format;
+    frame_stamp_t stamp;
+} burst_frame_t;
+
+static SemaphoreHandle_t s_lock = NULL;
+static uint8_t *s_staging = NULL;
+static size_t s_staging_size = 0;
+static burst_frame_t s_frames[CONFIG_BURST_MAX_FRAMES];
+static int s_count = 0;
+static const uint8_t s_zero_block[TAR_BLOCK] = {0};
+
+esp_err_t burst_init(void)
+{
+    s_staging_size = (size_t)CONFIG_BURST_STAGING_SIZE_KB * 1024;
+    s_staging = heap_caps_malloc(s_staging_size, MALLOC_CAP_SPIRAM);
+    // Binary semaphore, taken by the httpd task and given back by the burst worker
+    s_lock = xSemaphoreCreateBinary();
+    if (s_lock != NULL) {
+        xSemaphoreGive(s_lock);
+    }
+    if (s_staging == NULL || s_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %d KB burst staging area", CONFIG_BURST_STAGING_SIZE_KB);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Staging area: %d KB, up to %d frames", CONFIG_BURST_STAGING_SIZE_KB, CONFIG_BURST_MAX_FRAMES);
+    return ESP_OK;
+}
+
+esp_err_t burst_begin(void)
+{
+    if (s_staging == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xSemaphoreTake(s_lock, 0) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t burst_capture(int n, uint32_t interval_ms, burst_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+
+    n = MIN(MAX(n, 1), CONFIG_BURST_MAX_FRAMES);
+    int64_t next_us = esp_timer_get_time();     // First frame must start after the request
+    int64_t first_us = 0;
+    int64_t last_us = 0;
+    size_t used = 0;
+    s_count = 0;
+
+    while (s_count < n) {
+        // Sleep through long intervals, the skip limit only covers a few seconds of frames
+        int64_t wait_us = next_us - esp_timer_get_time() - BURST_WAKE_EARLY_US;
+        if (wait_us > 0) {
+            vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+        }
+
+        camera_fb_t *fb = frame_stamp_fb_get_since(next_us, BURST_MAX_SKIP_FRAMES);
+        if (fb == NULL) {
+            ESP_LOGE(TAG, "Camera capture failed after %d frames", s_count);
+            break;
+        }
+        if (s_count == 0) {
+            idle_mgr_frame_ready();
+        }
+        if (fb->len > s_staging_size - used) {
+            esp_camera_fb_return(fb);
+            result->truncated = true;
+            break;
+        }
+
+        burst_frame_t *f = &s_frames[s_count];
+        f->offset = used;
+        f->len = fb->len;
+        f->width = fb->width;
+        f->height = fb->height;
+        f->format = fb->format;
+        frame_stamp_take(fb, &f->stamp);
+        memcpy(s_staging + used, fb->buf, fb->len);
+        used += fb->len;
+
+        last_us = frame_stamp_capture_us(fb);
+        if (s_count == 0) {
+            first_us = last_us;
+        }
+        esp_camera_fb_return(fb);
+        s_count++;
+
+        // interval 0 takes every frame at the sensor rate
+        next_us = last_us + (interval_ms > 0 ? (int64_t)interval_ms * 1000 - BURST_JITTER_US : 1);
+    }
+
+    if (s_count == 0) {
+        return ESP_FAIL;
+    }
+
+    result->frames = s_count;
+    result->truncated = s_count < n;
+    result->span_us = (uint32_t)(last_us - first_us);
+    result->bytes = used;
+    return ESP_OK;
+}
+
+void burst_end(void)
+{
+    xSemaphoreGive(s_lock);
+}
+
+static const char *frame_content_type(const burst_frame_t *f)
+{
+    return f->format == PIXFORMAT_JPEG ? "image/jpeg" : "application/octet-stream";
+}
+
+static esp_err_t send_multipart(httpd_req_t *req)
+{
+    char part_buf[256];
+    char timestamp[24];
+    esp_err_t res = ESP_OK;
+
+    httpd_resp_set_type(req, "multipart/mixed; boundary=" BURST_BOUNDARY);
+
+    for (int i = 0; i < s_count && res == ESP_OK; i++) {
+        const burst_frame_t *f = &s_frames[i];
+        frame_stamp_format_time(&f->stamp, timestamp, sizeof(timestamp));
+        int hlen = snprintf(part_buf, sizeof(part_buf),
+                            "--" BURST_BOUNDARY "\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %lu\r\n"
+                            "X-Timestamp: %s\r\n"
+                            "X-Frame-Seq: %lu\r\n"
+                            "X-Frame-Index: %d\r\n"
+                            "X-Width: %u\r\nX-Height: %u\r\n\r\n",
+                            frame_content_type(f), (unsigned long)f->len, timestamp,
+                            (unsigned long)f->stamp.seq, i, f->width, f->height);
+        res = httpd_resp_send_chunk(req, part_buf, hlen);
+        if (res == ESP_OK) {
+            res = httpd_resp_send_chunk(req, (const char *)s_staging + f->offset, f->len);
+        }
+        if (res == ESP_OK) {
+            res = httpd_resp_send_chunk(req, "\r\n", 2);
+        }
+    }
+    if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, "--" BURST_BOUNDARY "--\r\n", strlen("--" BURST_BOUNDARY "--\r\n"));
+    }
+    return res;
+}
+
+// ustar header for a regular file
+static void tar_header(uint8_t *h, const char *name, size_t size, int64_t mtime)
+{
+    memset(h, 0, TAR_BLOCK);
+    strlcpy((char *)h, name, 100);
+    memcpy(h + 100, "0000644", 8);                              // Mode
+    memcpy(h + 108, "0000000", 8);                              // uid
+    memcpy(h + 116, "0000000", 8);                              // gid
+    snprintf((char *)h + 124, 12, "%011lo", (unsigned long)size);
+    snprintf((char *)h + 136, 12, "%011lo", (unsigned long)(mtime > 0 ? mtime : 0));
+    h[156] = '0';                                               // Regular file
+    memcpy(h + 257, "ustar", 6);
+    memcpy(h + 263, "00", 2);
+
+    // Checksum is computed with its own field filled with spaces
+    memset(h + 148, ' ', 8);
+    unsigned sum = 0;
+    for (int i = 0; i < TAR_BLOCK; i++) {
+        sum += h[i];
+    }
+    snprintf((char *)h + 148, 8, "%06o", sum);
+    h[155] = ' ';
+}
+
+static esp_err_t tar_pad(httpd_req_t *req, size_t len)
+{
+    size_t pad = (TAR_BLOCK - len % TAR_BLOCK) % TAR_BLOCK;
+    return pad ? httpd_resp_send_chunk(req, (const char *)s_zero_block, pad) : ESP_OK;
+}
+
+static esp_err_t send_tar(httpd_req_t *req)
+{
+    static char csv[64 * (CONFIG_BURST_MAX_FRAMES + 1)];
+    uint8_t header[TAR_BLOCK];
+    char name[32];
+    char timestamp[24];
+    esp_err_t res;
+
+    httpd_resp_set_type(req, "application/x-tar");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=burst.tar");
+
+    // Index with full-resolution timestamps first
+    char *p = csv;
+    p += sprintf(p, "index,file,seq,timestamp,bytes\n");
+    for (int i = 0; i < s_count; i++) {
+        const burst_frame_t *f = &s_frames[i];
+        frame_stamp_format_time(&f->stamp, timestamp, sizeof(timestamp));
+        p += sprintf(p, "%d,frame_%03d.%s,%lu,%s,%lu\n", i, i,
+                     f->format == PIXFORMAT_JPEG ? "jpg" : "raw",
+                     (unsigned long)f->stamp.seq, timestamp, (unsigned long)f->len);
+    }
+    size_t csv_len = p - csv;
+    int64_t mtime = s_frames[0].stamp.wall_us / 1000000;
+
+    tar_header(header, "timestamps.csv", csv_len, mtime);
+    res = httpd_resp_send_chunk(req, (const char *)header, TAR_BLOCK);
+    if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, csv, csv_len);
+    }
+    if (res == ESP_OK) {
+        res = tar_pad(req, csv_len);
+    }
+
+    for (int i = 0; i < s_count && res == ESP_OK; i++) {
+        const burst_frame_t *f = &s_frames[i];
+        snprintf(name, sizeof(name), "frame_%03d.%s", i, f->format == PIXFORMAT_JPEG ? "jpg" : "raw");
+        tar_header(header, name, f->len, f->stamp.wall_us / 1000000);
+        res = httpd_resp_send_chunk(req, (const char *)header, TAR_BLOCK);
+        if (res == ESP_OK) {
+            res = httpd_resp_send_chunk(req, (const char *)s_staging + f->offset, f->len);
+        }
+        if (res == ESP_OK) {
+            res = tar_pad(req, f->len);
+        }
+    }
+
+    // End of archive: two zero blocks
+    for (int i = 0; i < 2 && res == ESP_OK; i++) {
+        res = httpd_resp_send_chunk(req, (const char *)s_zero_block, TAR_BLOCK);
+    }
+    return res;
+}
+
+esp_err_t burst_send(httpd_req_t *req, burst_format_t format)
+{
+    esp_err_t res = format == BURST_FORMAT_TAR ? send_tar(req) : send_multipart(req);
+    if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return res;
+}
+
+bool burst_parse_format(const char *name, burst_format_t *format)
+{
+    if (strcmp(name, "multipart") == 0) {
+        *format = BURST_FORMAT_MULTIPART;
+        return true;
+    }
+    if (strcmp(name, "tar") == 0) {
+        *format = BURST_FORMAT_TAR;
+        return true;
+    }
+    return false;
+}
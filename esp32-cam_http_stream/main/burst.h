@@ -0,0 +1,46 @@
+/*
+ * ESP32-CAM 連拍 (Burst Capture)
+ *
+ * - /burst?n=N&interval=ms 以感測器原生速率連續擷取 N 張影格
+ * - 影格先複製到啟動時預先配置的 PSRAM 暫存區，全部擷取完成後才開始傳送，
+ *   網路速度不會影響影格間隔
+ * - 以 multipart/mixed 或 tar 封存回傳，附每張影格的時間戳記與序號
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+typedef enum {
+    BURST_FORMAT_MULTIPART = 0,
+    BURST_FORMAT_TAR,
+} burst_format_t;
+
+typedef struct {
+    int frames;             // Frames captured
+    bool truncated;         // Fewer than N frames (staging area full or capture failed)
+    uint32_t span_us;       // First to last frame start
+    uint32_t bytes;         // Staged bytes
+} burst_result_t;
+
+// Allocate the PSRAM staging area (call once at startup)
+esp_err_t burst_init(void);
+
+// Reserve the staging area, may be released from another task with burst_end()
+// Returns ESP_ERR_INVALID_STATE while another burst is in progress.
+esp_err_t burst_begin(void);
+
+// Capture up to n frames spaced at least interval_ms apart into the staging area
+// Caller holds the staging area (burst_begin()).
+esp_err_t burst_capture(int n, uint32_t interval_ms, burst_result_t *result);
+
+// Send the staged frames (response is completed)
+esp_err_t burst_send(httpd_req_t *req, burst_format_t format);
+
+// Release the staging area
+void burst_end(void);
+
+bool burst_parse_format(const char *name, burst_format_t *format);
@@ -18,6 +18,7 @@
 #include <nvs_flash.h>
 #include <sys/param.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -30,6 +31,17 @@
 #include <lwip/netdb.h>
 #include "mbedtls/base64.h"
 
+#include "perf_profile.h"
+#include "log_ring.h"
+#include "frame_stamp.h"
+#include "idle_mgr.h"
+#include "tls_server.h"
+#include "frame_stream.h"
+#include "flash_led.h"
+#include "burst.h"
+#include "wifi_perf.h"
+#include "sensor_lock.h"
+
 static const char *TAG = "camera_httpd";
 
 // ESP32-CAM (AI-Thinker) Pin Definition
@@ -51,11 +63,20 @@ static const char *TAG = "camera_httpd";
 #define CAM_PIN_HREF    23
 #define CAM_PIN_PCLK    22
 
+// mbedtls_ssl_write() needs more stack than a plain socket send
+#ifdef CONFIG_HTTPS_ENABLED
+#define STREAM_TASK_STACK 8192
+#else
+#define STREAM_TASK_STACK 6144
+#endif
+
 // MJPEG Stream Settings
 #define PART_BOUNDARY "123456789000000000000987654321"
 static const char* _STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
 static const char* _STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
-static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+static const char* _STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\nX-Timestamp: %s\r\nX-Frame-Seq: %lu\r\n\r\n";
+// Frames encoded on the fly have no known length, clients find the next boundary
+static const char* _STREAM_PART_ENCODED = "Content-Type: image/jpeg\r\nX-Timestamp: %s\r\nX-Frame-Seq: %lu\r\n\r\n";
 
 // Camera configuration
 static camera_config_t camera_config = {
@@ -77,22 +98,24 @@ static camera_config_t camera_config = {
     .pin_href = CAM_PIN_HREF,
     .pin_pclk = CAM_PIN_PCLK,
 
-    .xclk_freq_hz = 20000000,        // 20MHz XCLK (maximum stable frequency)
     .ledc_timer = LEDC_TIMER_0,
     .ledc_channel = LEDC_CHANNEL_0,
 
     .pixel_format = PIXFORMAT_JPEG,
-    .frame_size = FRAMESIZE_UXGA,    // 1600x1200 - UXGA (Maximum for OV2640)
-    .jpeg_quality = 12,              // 0-63 lower=higher quality, 12=balanced for speed
-    .fb_count = 3,                   // Triple buffer for maximum FPS with PSRAM
     .fb_location = CAMERA_FB_IN_PSRAM, // Use PSRAM for frame buffers
-    .grab_mode = CAMERA_GRAB_WHEN_EMPTY
+
+    // xclk_freq_hz, frame_size, jpeg_quality, fb_count and grab_mode
+    // are filled from the active performance profile (see perf_profile.c)
 };
 
-typedef struct {
-    httpd_req_t *req;
-    size_t len;
-} jpg_chunking_t;
+// Active performance profile
+static const perf_profile_t *active_profile = NULL;
+
+// Number of /stream clients currently being served, a running /burst counts as one
+static atomic_int active_streams = 0;
+
+// A /burst worker owns the camera
+static atomic_bool burst_running = false;
 
 // Check if client is from local network
 static bool is_local_client(httpd_req_t *req)
@@ -102,7 +125,7 @@ static bool is_local_client(httpd_req_t *req)
     socklen_t addr_size = sizeof(addr);
     
     if (getpeername(sockfd, (struct sockaddr *)&addr, &addr_size) != 0) {
-        ESP_LOGW(TAG, "Failed to get peer address");
+        LOG_RING_W(TAG, "Failed to get peer address");
         return false;
     }
     
@@ -110,7 +133,7 @@ static bool is_local_client(httpd_req_t *req)
     esp_netif_ip_info_t ip_info;
     esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
     if (netif == NULL || esp_netif_get_ip_info(netif, &ip_info) != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to get local IP info");
+        LOG_RING_W(TAG, "Failed to get local IP info");
         return false;
     }
     
@@ -123,14 +146,14 @@ static bool is_local_client(httpd_req_t *req)
             // Extract IPv4 address from IPv4-mapped IPv6
             client_ip = *((uint32_t *)(addr_bytes + 12));
         } else {
-            ESP_LOGW(TAG, "Pure IPv6 not supported for local check");
+            LOG_RING_W(TAG, "Pure IPv6 not supported for local check");
             return false;
         }
     } else if (addr.sin6_family == AF_INET) {
         struct sockaddr_in *addr_in = (struct sockaddr_in *)&addr;
         client_ip = addr_in->sin_addr.s_addr;
     } else {
-        ESP_LOGW(TAG, "Unknown address family");
+        LOG_RING_W(TAG, "Unknown address family");
         return false;
     }
     
@@ -141,7 +164,7 @@ static bool is_local_client(httpd_req_t *req)
     bool is_local = (client_ip & netmask) == (local_ip & netmask);
     
     if (!is_local) {
-        ESP_LOGW(TAG, "Access denied: Client IP 0x%08lx not in local network (0x%08lx/0x%08lx)",
+        LOG_RING_W(TAG, "Access denied: Client IP 0x%08lx not in local network (0x%08lx/0x%08lx)",
                  (unsigned long)client_ip, (unsigned long)local_ip, (unsigned long)netmask);
     }
     
@@ -156,13 +179,13 @@ static bool check_basic_auth(httpd_req_t *req)
     int ret = httpd_req_get_hdr_value_str(req, "Authorization", auth_header, sizeof(auth_header));
     
     if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "No Authorization header found");
+        LOG_RING_W(TAG, "No Authorization header found");
         return false;
     }
     
     // Check if it starts with "Basic "
     if (strncmp(auth_header, "Basic ", 6) != 0) {
-        ESP_LOGW(TAG, "Invalid Authorization header format");
+        LOG_RING_W(TAG, "Invalid Authorization header format");
         return false;
     }
     
@@ -174,7 +197,7 @@ static bool check_basic_auth(httpd_req_t *req)
                                   strlen(auth_header + 6));
     
     if (ret != 0) {
-        ESP_LOGW(TAG, "Base64 decode failed");
+        LOG_RING_W(TAG, "Base64 decode failed");
         return false;
     }
     
@@ -186,11 +209,11 @@ static bool check_basic_auth(httpd_req_t *req)
              CONFIG_HTTP_AUTH_USERNAME, CONFIG_HTTP_AUTH_PASSWORD);
     
     if (strcmp((char *)decoded, expected) == 0) {
-        ESP_LOGI(TAG, "Authentication successful");
+        LOG_RING_I(TAG, "Authentication successful");
         return true;
     }
     
-    ESP_LOGW(TAG, "Authentication failed: Invalid credentials");
+    LOG_RING_W(TAG, "Authentication failed: Invalid credentials");
     return false;
 #else
     return true;  // Auth disabled
@@ -287,21 +310,9 @@ static void check_psram()
     ESP_LOGI(TAG, "========================");
 }
 
-// Initialize camera
-static esp_err_t init_camera()
+// Apply default sensor adjustments
+static void configure_sensor(void)
 {
-    ESP_LOGI(TAG, "Checking PSRAM before camera initialization...");
-    check_psram();
-    
-    ESP_LOGI(TAG, "Initializing camera with PSRAM...");
-    
-    esp_err_t err = esp_camera_init(&camera_config);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Camera Init Failed with error 0x%x", err);
-        return err;
-    }
-    
-    // Get camera sensor
     sensor_t * s = esp_camera_sensor_get();
     if (s != NULL) {
         // Initial adjustments
@@ -328,32 +339,128 @@ static esp_err_t init_camera()
         s->set_dcw(s, 1);            // 0 = disable , 1 = enable
         s->set_colorbar(s, 0);       // 0 = disable , 1 = enable
     }
+}
+
+// Copy profile camera settings into camera_config
+static void load_profile_config(const perf_profile_t *profile)
+{
+    camera_config.xclk_freq_hz = profile->xclk_freq_hz;
+    camera_config.frame_size = profile->frame_size;
+    camera_config.jpeg_quality = profile->jpeg_quality;
+    camera_config.fb_count = profile->fb_count;
+    camera_config.grab_mode = profile->grab_mode;
+}
+
+// Initialize camera
+static esp_err_t init_camera()
+{
+    ESP_LOGI(TAG, "Checking PSRAM before camera initialization...");
+    check_psram();
+    
+    ESP_LOGI(TAG, "Initializing camera with PSRAM (profile: %s)...", active_profile->name);
+    load_profile_config(active_profile);
+    
+    esp_err_t err = esp_camera_init(&camera_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Camera Init Failed with error 0x%x", err);
+        return err;
+    }
+    
+    configure_sensor();
     
     ESP_LOGI(TAG, "Camera initialized successfully");
     return ESP_OK;
 }
 
-// MJPEG Stream Handler
-static esp_err_t stream_handler(httpd_req_t *req)
+// Switch to another profile at runtime
+// Only quality changes are applied in place, everything else re-initializes the driver.
+// Socket limits are read by start_webserver() and take effect after a reboot.
+// Caller holds the sensor lock.
+static esp_err_t apply_profile(const perf_profile_t *profile)
 {
-    // Check authentication
-    if (!check_basic_auth(req)) {
-        return send_auth_required(req);
+    const perf_profile_t *previous = active_profile;
+    sensor_t * s = esp_camera_sensor_get();
+    
+    // A driver left down by a failed switch always needs a full re-init
+    if (s != NULL &&
+        profile->frame_size == camera_config.frame_size &&
+        profile->fb_count == camera_config.fb_count &&
+        profile->grab_mode == camera_config.grab_mode &&
+        profile->xclk_freq_hz == camera_config.xclk_freq_hz) {
+        if (s->set_quality(s, profile->jpeg_quality) != 0) {
+            return ESP_FAIL;
+        }
+        camera_config.jpeg_quality = profile->jpeg_quality;
+        active_profile = profile;
+        return ESP_OK;
     }
     
-    // Check if client is from local network
-    if (!is_local_client(req)) {
-        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
-        return ESP_FAIL;
+    esp_camera_deinit();
+    frame_stamp_reset_period();
+    load_profile_config(profile);
+    esp_err_t err = esp_camera_init(&camera_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Profile %s failed (0x%x), restoring %s", profile->name, err, previous->name);
+        load_profile_config(previous);
+        if (esp_camera_init(&camera_config) == ESP_OK) {
+            configure_sensor();
+        } else {
+            // Reported as "camera":false in /status, retry with /profile?name=...
+            ESP_LOGE(TAG, "Restoring %s failed, camera unavailable", previous->name);
+        }
+        return err;
     }
     
+    configure_sensor();
+    active_profile = profile;
+    return ESP_OK;
+}
+
+// Send JPEG data, inserting the timestamp COM segment after SOI (and JFIF APP0)
+static esp_err_t send_jpeg_chunks(httpd_req_t *req, const uint8_t *jpg, size_t len,
+                                  const uint8_t *com, size_t com_len)
+{
+    size_t offset = frame_stamp_com_offset(jpg, len);
+    if (com_len == 0 || offset == 0) {
+        return httpd_resp_send_chunk(req, (const char *)jpg, len);
+    }
+    
+    esp_err_t res = httpd_resp_send_chunk(req, (const char *)jpg, offset);
+    if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, (const char *)com, com_len);
+    }
+    if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, (const char *)jpg + offset, len - offset);
+    }
+    return res;
+}
+
+// COM segment for a JPEG buffer, 0 if disabled or there is nowhere valid to insert it
+static size_t jpeg_com_segment(const frame_stamp_t *stamp, const uint8_t *jpg, size_t len,
+                               uint8_t *com, size_t com_size)
+{
+    if (frame_stamp_com_offset(jpg, len) == 0) {
+        return 0;
+    }
+    return frame_stamp_com_segment(stamp, com, com_size);
+}
+
+// Send MJPEG frames until the client disconnects
+static esp_err_t stream_frames(httpd_req_t *req)
+{
     camera_fb_t * fb = NULL;
     esp_err_t res = ESP_OK;
-    size_t _jpg_buf_len = 0;
-    uint8_t * _jpg_buf = NULL;
-    char part_buf[64];
+    char part_buf[128];
+    char framerate[8];
+    char timestamp[24];
+    uint8_t com_buf[FRAME_STAMP_COM_MAX];
+    size_t com_len = 0;
+    size_t frame_len = 0;
+    frame_stamp_t stamp;
+    const uint32_t interval_ms = active_profile->frame_interval_ms;
+    TickType_t last_wake = xTaskGetTickCount();
     
-    ESP_LOGI(TAG, "Stream session started");
+    LOG_RING_I(TAG, "Stream session started");
     
     res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
     if(res != ESP_OK){
@@ -362,7 +469,10 @@ static esp_err_t stream_handler(httpd_req_t *req)
     }
     
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "X-Framerate", "10");
+    if (interval_ms > 0) {
+        snprintf(framerate, sizeof(framerate), "%lu", (unsigned long)(1000 / interval_ms));
+        httpd_resp_set_hdr(req, "X-Framerate", framerate);
+    }
     
     while(true){
         fb = esp_camera_fb_get();
@@ -372,53 +482,125 @@ static esp_err_t stream_handler(httpd_req_t *req)
             break;
         }
         
-        if(fb->format != PIXFORMAT_JPEG){
-            bool jpeg_converted = frame2jpg(fb, 80, &_jpg_buf, &_jpg_buf_len);
+        // Skip frames left in the buffers from before a standby
+        if (idle_mgr_frame_is_stale(fb)) {
             esp_camera_fb_return(fb);
             fb = NULL;
-            if(!jpeg_converted){
-                ESP_LOGE(TAG, "JPEG compression failed");
-                res = ESP_FAIL;
-                break;
-            }
-        } else {
-            _jpg_buf_len = fb->len;
-            _jpg_buf = fb->buf;
+            continue;
         }
+        idle_mgr_frame_ready();
         
-        if(res == ESP_OK){
-            size_t hlen = snprintf(part_buf, 64, _STREAM_PART, _jpg_buf_len);
+        frame_stamp_take(fb, &stamp);
+        frame_stamp_format_time(&stamp, timestamp, sizeof(timestamp));
+        
+        if(fb->format != PIXFORMAT_JPEG){
+            // Encode straight into pooled chunk buffers, no per-frame output buffer
+            com_len = frame_stamp_com_segment(&stamp, com_buf, sizeof(com_buf));
+            size_t hlen = snprintf(part_buf, sizeof(part_buf), _STREAM_PART_ENCODED,
+                                   timestamp, (unsigned long)stamp.seq);
+            res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
+            if(res == ESP_OK){
+                res = frame_stream_send_jpeg(req, fb, 80, com_buf, com_len, &frame_len);
+            }
+        } else {
+            com_len = jpeg_com_segment(&stamp, fb->buf, fb->len, com_buf, sizeof(com_buf));
+            size_t hlen = snprintf(part_buf, sizeof(part_buf), _STREAM_PART,
+                                   fb->len + com_len, timestamp, (unsigned long)stamp.seq);
             res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
+            if(res == ESP_OK){
+                res = send_jpeg_chunks(req, fb->buf, fb->len, com_buf, com_len);
+            }
+            frame_len = fb->len + com_len;
         }
         if(res == ESP_OK){
-            res = httpd_resp_send_chunk(req, (const char *)_jpg_buf, _jpg_buf_len);
+            res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
         }
         if(res == ESP_OK){
-            res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+            wifi_perf_stream_bytes(frame_len);
         }
         
-        if(fb){
-            esp_camera_fb_return(fb);
-            fb = NULL;
-            _jpg_buf = NULL;
-        } else if(_jpg_buf){
-            free(_jpg_buf);
-            _jpg_buf = NULL;
-        }
+        esp_camera_fb_return(fb);
+        fb = NULL;
         
         if(res != ESP_OK){
-            ESP_LOGI(TAG, "Client disconnected");
+            LOG_RING_I(TAG, "Client disconnected");
             break;
         }
         
-        // Small delay to prevent CPU overload
-        vTaskDelay(pdMS_TO_TICKS(100));
+        // Pace frames according to the active profile
+        if (interval_ms > 0) {
+            xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(interval_ms));
+        } else {
+            taskYIELD();
+        }
     }
     
-    ESP_LOGI(TAG, "Stream session ended");
+    LOG_RING_I(TAG, "Stream session ended");
     return res;
 }
 
+// Worker task serving one stream outside the httpd task
+static void stream_task(void *arg)
+{
+    httpd_req_t *req = (httpd_req_t *)arg;
+    
+    stream_frames(req);
+    httpd_req_async_handler_complete(req);
+    idle_mgr_release();
+    atomic_fetch_sub(&active_streams, 1);
+    vTaskDelete(NULL);
+}
+
+// MJPEG Stream Handler
+static esp_err_t stream_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    // A burst needs every frame at the sensor rate
+    if (atomic_load(&burst_running)) {
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_sendstr(req, "Burst capture in progress");
+    }
+    
+    // Limit concurrent viewers to what the active profile allows
+    if (atomic_fetch_add(&active_streams, 1) >= active_profile->max_streams) {
+        atomic_fetch_sub(&active_streams, 1);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "5");
+        return httpd_resp_sendstr(req, "Too many stream clients");
+    }
+    
+    // Hand the request to a worker so the server keeps serving other URIs
+    httpd_req_t *async_req = NULL;
+    if (httpd_req_async_handler_begin(req, &async_req) != ESP_OK) {
+        atomic_fetch_sub(&active_streams, 1);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    // Wake the camera here so the worker starts with the sensor running
+    idle_mgr_acquire();
+    
+    if (xTaskCreate(stream_task, "stream", STREAM_TASK_STACK, async_req, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stream task");
+        httpd_req_async_handler_complete(async_req);
+        idle_mgr_release();
+        atomic_fetch_sub(&active_streams, 1);
+        return ESP_FAIL;
+    }
+    
+    return ESP_OK;
+}
+
 // Capture single image handler
 static esp_err_t capture_handler(httpd_req_t *req)
 {
@@ -433,31 +615,104 @@ static esp_err_t capture_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
+    // Optional output format: /capture?format=jpeg|rgb565|gray|bmp
+    // Optional flash pulse:   /capture?flash=1
+    char query[48];
+    char value[16];
+    frame_format_t format = FRAME_FORMAT_JPEG;
+    bool flash = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK &&
+            !frame_stream_parse_format(value, &format)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown format");
+            return ESP_FAIL;
+        }
+        if (httpd_query_key_value(query, "flash", value, sizeof(value)) == ESP_OK) {
+            flash = atoi(value) != 0;
+        }
+    }
+    
+    // Frames taken here would leave gaps in a running burst
+    if (atomic_load(&burst_running)) {
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_sendstr(req, "Burst capture in progress");
+    }
+    
     camera_fb_t * fb = NULL;
     esp_err_t res = ESP_OK;
     
-    // Flush old frames from buffer (fb_count = 3, so flush 3 times)
-    for (int i = 0; i < 3; i++) {
-        fb = esp_camera_fb_get();
-        if (fb) {
-            esp_camera_fb_return(fb);
+    idle_mgr_acquire();
+    
+    if (flash) {
+        // Frame is picked by timestamp, no flush needed
+        fb = flash_led_capture(camera_config.grab_mode);
+    } else {
+        // Flush old frames from buffer (one per frame buffer)
+        for (int i = 0; i < (int)camera_config.fb_count; i++) {
+            fb = esp_camera_fb_get();
+            if (fb) {
+                esp_camera_fb_return(fb);
+            }
         }
+        
+        // Now get the fresh frame
+        fb = esp_camera_fb_get();
     }
-    
-    // Now get the fresh frame
-    fb = esp_camera_fb_get();
     if (!fb) {
         ESP_LOGE(TAG, "Camera capture failed");
+        idle_mgr_release();
         httpd_resp_send_500(req);
         return ESP_FAIL;
     }
+    idle_mgr_frame_ready();
+    
+    frame_stamp_t stamp;
+    char timestamp[24];
+    char seq[12];
+    char filename[40];
+    uint8_t com_buf[FRAME_STAMP_COM_MAX];
+    frame_stamp_take(fb, &stamp);
+    frame_stamp_format_time(&stamp, timestamp, sizeof(timestamp));
+    snprintf(seq, sizeof(seq), "%lu", (unsigned long)stamp.seq);
+    snprintf(filename, sizeof(filename), "inline; filename=capture.%s",
+             format == FRAME_FORMAT_JPEG ? "jpg" : format == FRAME_FORMAT_BMP ? "bmp" : "raw");
     
-    httpd_resp_set_type(req, "image/jpeg");
-    httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=capture.jpg");
+    httpd_resp_set_type(req, frame_stream_content_type(format));
+    httpd_resp_set_hdr(req, "Content-Disposition", filename);
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "X-Timestamp", timestamp);
+    httpd_resp_set_hdr(req, "X-Frame-Seq", seq);
+    
+    size_t com_len = 0;
+    if (format != FRAME_FORMAT_JPEG) {
+        // Raw outputs are converted row by row into pooled chunk buffers
+        char width[8];
+        char height[8];
+        snprintf(width, sizeof(width), "%u", (unsigned)fb->width);
+        snprintf(height, sizeof(height), "%u", (unsigned)fb->height);
+        httpd_resp_set_hdr(req, "X-Width", width);
+        httpd_resp_set_hdr(req, "X-Height", height);
+        httpd_resp_set_hdr(req, "X-Format", frame_stream_format_name(format));
+        res = frame_stream_send_raw(req, fb, format);
+    } else if (fb->format != PIXFORMAT_JPEG) {
+        com_len = frame_stamp_com_segment(&stamp, com_buf, sizeof(com_buf));
+        res = frame_stream_send_jpeg(req, fb, 80, com_buf, com_len, NULL);
+    } else {
+        com_len = jpeg_com_segment(&stamp, fb->buf, fb->len, com_buf, sizeof(com_buf));
+        if (com_len == 0) {
+            res = httpd_resp_send(req, (const char *)fb->buf, fb->len);
+        } else {
+            res = send_jpeg_chunks(req, fb->buf, fb->len, com_buf, com_len);
+        }
+    }
     
-    res = httpd_resp_send(req, (const char *)fb->buf, fb->len);
+    // Everything except a plain JPEG went out as chunks
+    bool chunked = format != FRAME_FORMAT_JPEG || fb->format != PIXFORMAT_JPEG || com_len > 0;
+    if (chunked && res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, NULL, 0);
+    }
     esp_camera_fb_return(fb);
+    idle_mgr_release();
     return res;
 }
 
@@ -469,19 +724,70 @@ static esp_err_t status_handler(httpd_req_t *req)
         return send_auth_required(req);
     }
     
-    static char json_response[1024];
+    static char json_response[1536];
     
     sensor_t * s = esp_camera_sensor_get();
     char * p = json_response;
     *p++ = '{';
     
-    p+=sprintf(p, "\"framesize\":%u,", s->status.framesize);
-    p+=sprintf(p, "\"quality\":%u,", s->status.quality);
-    p+=sprintf(p, "\"brightness\":%d,", s->status.brightness);
-    p+=sprintf(p, "\"contrast\":%d,", s->status.contrast);
-    p+=sprintf(p, "\"saturation\":%d,", s->status.saturation);
-    p+=sprintf(p, "\"hmirror\":%u,", s->status.hmirror);
-    p+=sprintf(p, "\"vflip\":%u", s->status.vflip);
+    // NULL after a failed profile switch left the driver deinitialized
+    p+=sprintf(p, "\"camera\":%s,", s != NULL ? "true" : "false");
+    if (s != NULL) {
+        p+=sprintf(p, "\"framesize\":%u,", s->status.framesize);
+        p+=sprintf(p, "\"quality\":%u,", s->status.quality);
+        p+=sprintf(p, "\"brightness\":%d,", s->status.brightness);
+        p+=sprintf(p, "\"contrast\":%d,", s->status.contrast);
+        p+=sprintf(p, "\"saturation\":%d,", s->status.saturation);
+        p+=sprintf(p, "\"hmirror\":%u,", s->status.hmirror);
+        p+=sprintf(p, "\"vflip\":%u,", s->status.vflip);
+    }
+    p+=sprintf(p, "\"profile\":\"%s\",", active_profile->name);
+    p+=sprintf(p, "\"streams\":%d,", atomic_load(&active_streams));
+    p+=sprintf(p, "\"heap_free\":%u,\"heap_min_free\":%u,",
+               (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+               (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    p+=sprintf(p, "\"psram_free\":%u,\"psram_total\":%u,",
+               (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+               (unsigned)heap_caps_get_total_size(MALLOC_CAP_SPIRAM));
+    p+=sprintf(p, "\"time_synced\":%s,", frame_stamp_time_synced() ? "true" : "false");
+    
+    idle_mgr_stats_t idle;
+    idle_mgr_get_stats(&idle);
+    p+=sprintf(p, "\"standby\":%s,", idle.standby ? "true" : "false");
+    p+=sprintf(p, "\"standby_count\":%lu,", (unsigned long)idle.standby_count);
+    p+=sprintf(p, "\"wake_count\":%lu,", (unsigned long)idle.wake_count);
+    p+=sprintf(p, "\"wake_to_frame_ms\":%.1f,", idle.last_wake_us / 1000.0);
+    p+=sprintf(p, "\"wake_to_frame_max_ms\":%.1f,", idle.max_wake_us / 1000.0);
+    
+    tls_server_stats_t tls;
+    tls_server_get_stats(&tls);
+    uint32_t handshakes = tls.full_handshakes + tls.resumed_handshakes;
+    p+=sprintf(p, "\"https\":%s,", tls_server_ready() ? "true" : "false");
+    p+=sprintf(p, "\"tls_handshakes\":%lu,", (unsigned long)handshakes);
+    p+=sprintf(p, "\"tls_resumed\":%lu,", (unsigned long)tls.resumed_handshakes);
+    p+=sprintf(p, "\"tls_failed\":%lu,", (unsigned long)tls.failed_handshakes);
+    p+=sprintf(p, "\"tls_resume_rate\":%.2f,", handshakes ? (float)tls.resumed_handshakes / handshakes : 0.0f);
+    p+=sprintf(p, "\"tls_full_ms\":%.1f,",
+               tls.full_handshakes ? tls.full_total_us / 1000.0 / tls.full_handshakes : 0.0);
+    p+=sprintf(p, "\"tls_resumed_ms\":%.1f,",
+               tls.resumed_handshakes ? tls.resumed_total_us / 1000.0 / tls.resumed_handshakes : 0.0);
+    
+    flash_led_stats_t flash;
+    flash_led_get_stats(&flash);
+    p+=sprintf(p, "\"flash\":\"%s\",", flash_led_mode_name(flash.mode));
+    p+=sprintf(p, "\"flash_duty\":%u,", flash.duty);
+    p+=sprintf(p, "\"flash_pulses\":%lu,", (unsigned long)flash.pulses);
+    
+    wifi_perf_stats_t wifi;
+    wifi_perf_get_stats(&wifi);
+    p+=sprintf(p, "\"rssi\":%d,\"channel\":%u,", wifi.rssi, wifi.channel);
+    p+=sprintf(p, "\"phy\":\"%s\",\"bandwidth\":\"%s\",", wifi.phy, wifi.bandwidth);
+    p+=sprintf(p, "\"wifi_ps\":\"%s\",\"tx_power_dbm\":%.2f,", wifi.ps, wifi.tx_power_dbm);
+    p+=sprintf(p, "\"tcp_xmit\":%lu,\"tcp_rexmit\":%lu,",
+               (unsigned long)wifi.tcp_xmit, (unsigned long)wifi.tcp_rexmit);
+    p+=sprintf(p, "\"stream_kbps\":%lu,", (unsigned long)(wifi.stream_bps / 1000));
+    p+=sprintf(p, "\"net_bench_bytes\":%lu,", (unsigned long)wifi.bench_bytes);
+    p+=sprintf(p, "\"net_bench_kbps\":%lu", (unsigned long)wifi.bench_kbps);
     *p++ = '}';
     *p++ = 0;
     
@@ -490,6 +796,382 @@ static esp_err_t status_handler(httpd_req_t *req)
     return httpd_resp_send(req, json_response, strlen(json_response));
 }
 
+// Parameters handed to the burst worker, only one burst runs at a time
+typedef struct {
+    httpd_req_t *req;
+    int n;
+    int interval_ms;
+    burst_format_t format;
+} burst_job_t;
+
+static burst_job_t burst_job;
+
+// Capture and send one burst outside the httpd task
+static void burst_task(void *arg)
+{
+    burst_job_t *job = (burst_job_t *)arg;
+    httpd_req_t *req = job->req;
+    
+    burst_result_t result;
+    esp_err_t res = burst_capture(job->n, job->interval_ms, &result);
+    // Frames are staged, the sensor may go back to standby while sending
+    idle_mgr_release();
+    
+    if (res != ESP_OK) {
+        httpd_resp_send_500(req);
+    } else {
+        char frames[8];
+        char span[16];
+        snprintf(frames, sizeof(frames), "%d", result.frames);
+        snprintf(span, sizeof(span), "%lu", (unsigned long)(result.span_us / 1000));
+        httpd_resp_set_hdr(req, "X-Burst-Frames", frames);
+        httpd_resp_set_hdr(req, "X-Burst-Span-Ms", span);
+        httpd_resp_set_hdr(req, "X-Burst-Truncated", result.truncated ? "1" : "0");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        
+        int64_t fr_start = esp_timer_get_time();
+        res = burst_send(req, job->format);
+        ESP_LOGI(TAG, "Burst: %d frames in %lums, %luKB sent in %lums%s",
+                 result.frames, (unsigned long)(result.span_us / 1000), (unsigned long)(result.bytes / 1024),
+                 (unsigned long)((esp_timer_get_time() - fr_start) / 1000), result.truncated ? " (truncated)" : "");
+    }
+    
+    httpd_req_async_handler_complete(req);
+    atomic_store(&burst_running, false);
+    atomic_fetch_sub(&active_streams, 1);
+    burst_end();
+    vTaskDelete(NULL);
+}
+
+// Burst handler - /burst?n=<frames>&interval=<ms>&format=multipart|tar
+static esp_err_t burst_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    int n = 5;
+    int interval_ms = 0;
+    burst_format_t format = BURST_FORMAT_MULTIPART;
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "n", value, sizeof(value)) == ESP_OK) {
+            n = MIN(MAX(atoi(value), 1), CONFIG_BURST_MAX_FRAMES);
+        }
+        if (httpd_query_key_value(query, "interval", value, sizeof(value)) == ESP_OK) {
+            interval_ms = MIN(MAX(atoi(value), 0), 10000);
+        }
+        if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK &&
+            !burst_parse_format(value, &format)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown burst format");
+            return ESP_FAIL;
+        }
+    }
+    
+    esp_err_t res = burst_begin();
+    if (res == ESP_ERR_INVALID_STATE) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        return httpd_resp_sendstr(req, "Another burst is in progress");
+    }
+    if (res != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    // Streams would compete for the same frame buffers and stretch the spacing.
+    // The worker counts as a stream so profile switches and new streams are refused.
+    if (atomic_fetch_add(&active_streams, 1) > 0) {
+        atomic_fetch_sub(&active_streams, 1);
+        burst_end();
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_sendstr(req, "Stop all streams before a burst capture");
+    }
+    atomic_store(&burst_running, true);
+    
+    // Long bursts run for minutes, hand them to a worker so other URIs stay responsive
+    burst_job.req = NULL;
+    burst_job.n = n;
+    burst_job.interval_ms = interval_ms;
+    burst_job.format = format;
+    if (httpd_req_async_handler_begin(req, &burst_job.req) != ESP_OK) {
+        atomic_store(&burst_running, false);
+        atomic_fetch_sub(&active_streams, 1);
+        burst_end();
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    idle_mgr_acquire();
+    
+    if (xTaskCreate(burst_task, "burst", STREAM_TASK_STACK, &burst_job, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create burst task");
+        httpd_req_async_handler_complete(burst_job.req);
+        idle_mgr_release();
+        atomic_store(&burst_running, false);
+        atomic_fetch_sub(&active_streams, 1);
+        burst_end();
+        return ESP_FAIL;
+    }
+    
+    return ESP_OK;
+}
+
+// Profile handler - list profiles or switch with /profile?name=<profile>
+static esp_err_t profile_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    char query[64];
+    char name[32];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "name", name, sizeof(name)) == ESP_OK) {
+        const perf_profile_t *profile = perf_profile_find(name);
+        if (profile == NULL) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown profile");
+            return ESP_FAIL;
+        }
+        
+        // The camera driver cannot be re-initialized under an active stream
+        if (atomic_load(&active_streams) > 0) {
+            httpd_resp_set_status(req, "409 Conflict");
+            return httpd_resp_sendstr(req, "Stop all streams before switching profile");
+        }
+        
+        // Re-applying the active profile retries a camera left down by a failed switch
+        if (profile != active_profile || esp_camera_sensor_get() == NULL) {
+            ESP_LOGI(TAG, "Switching profile: %s -> %s", active_profile->name, profile->name);
+            idle_mgr_acquire();
+            sensor_lock_take();
+            esp_err_t err = apply_profile(profile);
+            sensor_lock_give();
+            idle_mgr_release();
+            if (err != ESP_OK) {
+                httpd_resp_send_500(req);
+                return ESP_FAIL;
+            }
+            perf_profile_save(profile);
+        }
+    }
+    
+    static char json_response[1024];
+    char * p = json_response;
+    p+=sprintf(p, "{\"active\":\"%s\",\"profiles\":[", active_profile->name);
+    for (size_t i = 0; i < perf_profile_count(); i++) {
+        const perf_profile_t *pr = perf_profile_at(i);
+        p+=sprintf(p, "%s{\"name\":\"%s\",\"framesize\":%u,\"quality\":%d,\"fb_count\":%u,"
+                      "\"grab_latest\":%s,\"xclk\":%d,\"interval_ms\":%lu,\"sockets\":%u,\"streams\":%u}",
+                   i ? "," : "", pr->name, pr->frame_size, pr->jpeg_quality, (unsigned)pr->fb_count,
+                   pr->grab_mode == CAMERA_GRAB_LATEST ? "true" : "false", pr->xclk_freq_hz,
+                   (unsigned long)pr->frame_interval_ms, pr->max_open_sockets, pr->max_streams);
+    }
+    p+=sprintf(p, "]}");
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, json_response, strlen(json_response));
+}
+
+// Logs handler - recent log ring entries as text, /logs?n=<count>
+static esp_err_t logs_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    size_t count = log_ring_capacity();
+    char query[32];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "n", value, sizeof(value)) == ESP_OK) {
+        count = MIN((size_t)atoi(value), count);
+    }
+    
+    httpd_resp_set_type(req, "text/plain; charset=utf-8");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    
+    log_ring_stats_t stats;
+    log_ring_get_stats(&stats);
+    
+    char line[LOG_RING_TAG_LEN + LOG_RING_MSG_LEN + 32];
+    snprintf(line, sizeof(line), "# written=%lu overwritten=%lu suppressed=%lu\n",
+             (unsigned long)stats.written, (unsigned long)stats.overwritten,
+             (unsigned long)stats.suppressed);
+    esp_err_t res = httpd_resp_sendstr_chunk(req, line);
+    
+    uint32_t head = log_ring_head();
+    uint32_t seq = head - MIN((uint32_t)count, head);
+    log_ring_entry_t entry;
+    for (; seq != head && res == ESP_OK; seq++) {
+        if (!log_ring_read(seq, &entry)) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%lu.%03lu %c %s: %s\n",
+                 (unsigned long)(entry.time_us / 1000000), (unsigned long)(entry.time_us / 1000 % 1000),
+                 "?EWIDV"[entry.level <= ESP_LOG_VERBOSE ? entry.level : 0], entry.tag, entry.msg);
+        res = httpd_resp_sendstr_chunk(req, line);
+    }
+    
+    if (res == ESP_OK) {
+        res = httpd_resp_sendstr_chunk(req, NULL);
+    }
+    return res;
+}
+
+// Encode benchmark - /bench/encode?n=<frames>&quality=<q>
+// Compares frame2jpg() against the pooled streaming encoder on a synthetic VGA frame.
+static esp_err_t bench_encode_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    uint32_t iterations = 10;
+    int quality = 80;
+    char query[48];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "n", value, sizeof(value)) == ESP_OK) {
+            iterations = MIN(MAX(atoi(value), 1), 100);
+        }
+        if (httpd_query_key_value(query, "quality", value, sizeof(value)) == ESP_OK) {
+            quality = MIN(MAX(atoi(value), 1), 100);
+        }
+    }
+    
+    frame_stream_bench_t bench;
+    if (frame_stream_bench(iterations, quality, &bench) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    char json_response[512];
+    char * p = json_response;
+    p+=sprintf(p, "{\"width\":%u,\"height\":%u,", bench.width, bench.height);
+    p+=sprintf(p, "\"iterations\":%lu,\"quality\":%d,", (unsigned long)bench.iterations, quality);
+    p+=sprintf(p, "\"jpeg_len\":%lu,", (unsigned long)bench.jpeg_len);
+    p+=sprintf(p, "\"frame2jpg\":{\"frame_ms\":%.2f,\"peak_heap\":%lu},",
+               bench.alloc_frame_us / 1000.0, (unsigned long)bench.alloc_peak_bytes);
+    p+=sprintf(p, "\"streaming\":{\"frame_ms\":%.2f,\"peak_heap\":%lu},",
+               bench.stream_frame_us / 1000.0, (unsigned long)bench.stream_peak_bytes);
+    
+    // Allocations frame2jpg_cb() still makes on every frame, at the bench width and at UXGA
+    size_t line, mcu_rows;
+    size_t uxga = frame_stream_encoder_alloc(1600, PIXFORMAT_RGB565, &line, &mcu_rows);
+    p+=sprintf(p, "\"per_frame_alloc\":{\"line\":%u,\"mcu_rows\":%u,\"total\":%u,\"uxga_total\":%u}}",
+               (unsigned)bench.enc_line_bytes, (unsigned)bench.enc_mcu_bytes,
+               (unsigned)(bench.enc_line_bytes + bench.enc_mcu_bytes), (unsigned)uxga);
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, json_response, strlen(json_response));
+}
+
+// Network benchmark - /bench/net?bytes=<n>
+// Streams a synthetic payload from a static buffer to measure TCP throughput without the camera.
+static esp_err_t bench_net_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    uint32_t bytes = 1024 * 1024;
+    char query[48];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "bytes", value, sizeof(value)) == ESP_OK) {
+        bytes = MIN(MAX(strtoul(value, NULL, 10), 1), (uint32_t)CONFIG_WIFI_PERF_BENCH_MAX_KB * 1024);
+    }
+    
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return wifi_perf_bench_send(req, bytes);
+}
+
+// Flash LED handler - /flash?mode=off|on|auto&brightness=<0-100>
+static esp_err_t flash_handler(httpd_req_t *req)
+{
+    // Check authentication
+    if (!check_basic_auth(req)) {
+        return send_auth_required(req);
+    }
+    
+    // Check if client is from local network
+    if (!is_local_client(req)) {
+        httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Access denied: Only local network access allowed");
+        return ESP_FAIL;
+    }
+    
+    char query[48];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "brightness", value, sizeof(value)) == ESP_OK) {
+            flash_led_set_brightness(MIN(MAX(atoi(value), 0), 100));
+        }
+        if (httpd_query_key_value(query, "mode", value, sizeof(value)) == ESP_OK) {
+            flash_mode_t mode;
+            if (!flash_led_parse_mode(value, &mode)) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown flash mode");
+                return ESP_FAIL;
+            }
+            flash_led_set_mode(mode);
+        }
+    }
+    
+    flash_led_stats_t flash;
+    flash_led_get_stats(&flash);
+    
+    char json_response[256];
+    char * p = json_response;
+    p+=sprintf(p, "{\"mode\":\"%s\",", flash_led_mode_name(flash.mode));
+    p+=sprintf(p, "\"brightness\":%u,\"duty\":%u,", flash.brightness, flash.duty);
+    p+=sprintf(p, "\"exposure\":%u,\"gain\":%.2f,", flash.exposure, flash.gain_x16 / 16.0);
+    p+=sprintf(p, "\"light_need\":%u,", flash.light_need);
+    p+=sprintf(p, "\"pulses\":%lu,\"pulse_misses\":%lu}",
+               (unsigned long)flash.pulses, (unsigned long)flash.pulse_misses);
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, json_response, strlen(json_response));
+}
+
 // Index page HTML
 static const char INDEX_HTML[] = R"rawliteral(
 <!DOCTYPE html>
@@ -686,9 +1368,17 @@ static httpd_handle_t start_webserver(void)
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
     config.ctrl_port = 32768;
-    config.max_uri_handlers = 8;
+    config.max_uri_handlers = 12;
     config.max_resp_headers = 8;
     config.stack_size = 8192;
+    config.max_open_sockets = active_profile->max_open_sockets;
+    config.lru_purge_enable = true;
+    
+    // Serve HTTPS instead when a certificate has been provisioned
+    if (tls_server_ready()) {
+        tls_server_configure(&config);
+        config.stack_size = 10240;  // Room for the RSA/ECDHE handshake
+    }
     
     ESP_LOGI(TAG, "Starting web server on port: '%d'", config.server_port);
     if (httpd_start(&server, &config) == ESP_OK) {
@@ -724,6 +1414,54 @@ static httpd_handle_t start_webserver(void)
         };
         httpd_register_uri_handler(server, &status_uri);
         
+        httpd_uri_t profile_uri = {
+            .uri       = "/profile",
+            .method    = HTTP_GET,
+            .handler   = profile_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &profile_uri);
+        
+        httpd_uri_t logs_uri = {
+            .uri       = "/logs",
+            .method    = HTTP_GET,
+            .handler   = logs_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &logs_uri);
+        
+        httpd_uri_t bench_encode_uri = {
+            .uri       = "/bench/encode",
+            .method    = HTTP_GET,
+            .handler   = bench_encode_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &bench_encode_uri);
+        
+        httpd_uri_t bench_net_uri = {
+            .uri       = "/bench/net",
+            .method    = HTTP_GET,
+            .handler   = bench_net_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &bench_net_uri);
+        
+        httpd_uri_t flash_uri = {
+            .uri       = "/flash",
+            .method    = HTTP_GET,
+            .handler   = flash_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &flash_uri);
+        
+        httpd_uri_t burst_uri = {
+            .uri       = "/burst",
+            .method    = HTTP_GET,
+            .handler   = burst_handler,
+            .user_ctx  = NULL
+        };
+        httpd_register_uri_handler(server, &burst_uri);
+        
         ESP_LOGI(TAG, "Web server started successfully");
         return server;
     }
@@ -768,6 +1506,10 @@ static void wifi_init_sta(void)
     
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    
+    // Power save / bandwidth / TX power from menuconfig (Wi-Fi Performance)
+    wifi_perf_init();
+    
     ESP_ERROR_CHECK(esp_wifi_start());
 
     ESP_LOGI(TAG, "WiFi initialized. Connecting to SSID:%s", CONFIG_ESP_WIFI_SSID);
@@ -785,22 +1527,49 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
     
+    // Move hot-path logging off the request path
+    log_ring_init();
+    
+    // Select performance profile (NVS override, else menuconfig default)
+    active_profile = perf_profile_load();
+    
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     
     // Initialize WiFi
     wifi_init_sta();
     
+    // Wall-clock time for frame timestamps
+    frame_stamp_init();
+    
     // Wait for WiFi connection (simple delay)
     ESP_LOGI(TAG, "Waiting for WiFi connection...");
     vTaskDelay(5000 / portTICK_PERIOD_MS);
     
+    // Serializes sensor register access with camera re-initialization
+    sensor_lock_init();
+    
     // Initialize camera
     if(init_camera() != ESP_OK) {
         ESP_LOGE(TAG, "Camera initialization failed!");
         return;
     }
     
+    // Chunk pool for streaming encode / raw capture formats
+    frame_stream_init();
+    
+    // PSRAM staging area for /burst
+    burst_init();
+    
+    // Put the sensor in standby when nobody is watching
+    idle_mgr_init(&camera_config);
+    
+    // Flash LED on GPIO 4 (PWM illumination / VSYNC-timed pulses)
+    flash_led_init();
+    
+    // HTTPS when a certificate is stored in NVS, otherwise plain HTTP
+    tls_server_init();
+    
     // Start web server
     start_webserver();
     
@@ -0,0 +1,386 @@
+/*
+ * ESP32-CAM 閃光燈控制 (Flash LED)
+ *
+ * OV2640 為捲簾快門: 在 VSYNC 邊緣 T0 點亮後，下一個 VSYNC (T1)
+ * 開始讀出的影格所有列都在點亮後才開始曝光 (曝光時間 <= 一個影格週期)，
+ * 於 T2 讀出完成即可熄滅，再依影格時間戳記 (影格開始時間) 取出該張。
+ * VSYNC 邊緣由兩張連續影格的時間戳記推算，以 esp_timer 單次計時器開關，
+ * 等待期間不佔用 CPU。
+ */
+
+#include <string.h>
+#include <sys/param.h>
+#include <esp_log.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+
+#include "flash_led.h"
+#include "idle_mgr.h"
+#include "frame_stamp.h"
+#include "sensor_lock.h"
+
+static const char *TAG = "flash_led";
+
+#ifdef CONFIG_FLASH_LED_ENABLED
+
+#define FLASH_LEDC_TIMER        LEDC_TIMER_1    // LEDC_TIMER_0 drives XCLK
+#define FLASH_LEDC_CHANNEL      LEDC_CHANNEL_1
+#define FLASH_PWM_FREQ_HZ       20000           // Far above the row exposure time, no banding
+#define FLASH_DUTY_MAX          1023            // 10-bit resolution
+#define FLASH_SYNC_FRAMES       3               // Frames used to measure the period, queued ones may be stale
+#define FLASH_MAX_PERIOD_US     (1000 * 1000)
+#define FLASH_TIMER_LEAD_US     2000            // Earliest edge the timers can still be armed for
+#define FLASH_AUTO_STEP_PCT     10
+#define FLASH_AUTO_HOLD_CHECKS  3               // Consecutive dark readings before switching on
+#define FLASH_MAX_SKIP_FRAMES   8
+
+// OV2640 sensor bank registers, read through sensor_t.get_reg()
+#define OV2640_SENSOR_BANK      0x100
+#define OV2640_REG_GAIN         (OV2640_SENSOR_BANK | 0x00)
+#define OV2640_REG_REG04        (OV2640_SENSOR_BANK | 0x04)     // AEC[1:0]
+#define OV2640_REG_AEC          (OV2640_SENSOR_BANK | 0x10)     // AEC[9:2]
+#define OV2640_REG_COM7         (OV2640_SENSOR_BANK | 0x12)     // Resolution mode
+#define OV2640_REG_REG45        (OV2640_SENSOR_BANK | 0x45)     // AEC[15:10]
+
+static SemaphoreHandle_t s_lock = NULL;
+static esp_timer_handle_t s_on_timer = NULL;
+static esp_timer_handle_t s_off_timer = NULL;
+static flash_mode_t s_mode = FLASH_MODE_OFF;
+static uint8_t s_brightness = CONFIG_FLASH_DEFAULT_BRIGHTNESS_PCT;
+static uint8_t s_duty = 0;
+static int s_dark_checks = 0;
+static flash_led_stats_t s_stats;
+
+static void set_duty(uint8_t percent)
+{
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, FLASH_LEDC_CHANNEL, (uint32_t)percent * FLASH_DUTY_MAX / 100);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, FLASH_LEDC_CHANNEL);
+}
+
+static void pulse_on(void *arg)
+{
+    set_duty(CONFIG_FLASH_PULSE_DUTY_PCT);
+}
+
+// Back to the continuous level, s_duty only changes under s_lock held by the capture
+static void pulse_off(void *arg)
+{
+    set_duty(s_duty);
+}
+
+static void pulse_cancel(void)
+{
+    esp_timer_stop(s_on_timer);
+    esp_timer_stop(s_off_timer);
+    set_duty(s_duty);
+}
+
+// Frame period and the start of the latest frame from consecutive frame timestamps
+static bool measure_frames(int64_t *period_us, int64_t *last_us)
+{
+    int64_t prev = -1;
+    *period_us = 0;
+    for (int i = 0; i < FLASH_SYNC_FRAMES; i++) {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (fb == NULL) {
+            return false;
+        }
+        int64_t start = frame_stamp_capture_us(fb);
+        esp_camera_fb_return(fb);
+        // Gaps after queued frames span several periods, keep the shortest
+        if (prev >= 0 && start > prev && (*period_us == 0 || start - prev < *period_us)) {
+            *period_us = start - prev;
+        }
+        prev = start;
+    }
+    *last_us = prev;
+    return *period_us > 0 && *period_us < FLASH_MAX_PERIOD_US;
+}
+
+// Read live exposure and gain, returns false for sensors other than the OV2640
+static bool read_exposure(uint16_t *exposure, uint16_t *gain_x16, uint16_t *frame_lines)
+{
+    // A /profile switch may be re-initializing the camera or writing another bank
+    sensor_lock_take();
+    sensor_t *s = esp_camera_sensor_get();
+    if (s == NULL || s->id.PID != OV2640_PID) {
+        sensor_lock_give();
+        return false;
+    }
+
+    int gain = s->get_reg(s, OV2640_REG_GAIN, 0xFF);
+    int aec_lo = s->get_reg(s, OV2640_REG_REG04, 0x03);
+    int aec_mid = s->get_reg(s, OV2640_REG_AEC, 0xFF);
+    int aec_hi = s->get_reg(s, OV2640_REG_REG45, 0x3F);
+    int com7 = s->get_reg(s, OV2640_REG_COM7, 0x70);
+    sensor_lock_give();
+    if (gain < 0 || aec_lo < 0 || aec_mid < 0 || aec_hi < 0 || com7 < 0) {
+        return false;
+    }
+
+    *exposure = (aec_hi << 10) | (aec_mid << 2) | aec_lo;
+    // Each of bits 7:4 doubles the gain, bits 3:0 add sixteenths
+    *gain_x16 = (16 + (gain & 0x0F)) << __builtin_popcount(gain >> 4);
+    // Frame length in lines for UXGA / SVGA / CIF sensor modes
+    *frame_lines = com7 == 0x40 ? 672 : com7 == 0x20 ? 336 : 1248;
+    return true;
+}
+
+// Auto mode: raise the duty while the sensor runs out of exposure, lower it once it has headroom
+static void auto_adjust(void)
+{
+    uint16_t exposure, gain_x16, frame_lines;
+    if (!read_exposure(&exposure, &gain_x16, &frame_lines)) {
+        return;
+    }
+
+    uint32_t fraction = MIN((uint32_t)exposure * 100 / frame_lines, 100);
+    uint8_t need = MIN(fraction * gain_x16 / 16, 200);
+    s_stats.exposure = exposure;
+    s_stats.gain_x16 = gain_x16;
+    s_stats.light_need = need;
+
+    if (need >= CONFIG_FLASH_AUTO_ON_LEVEL) {
+        if (s_duty == 0 && ++s_dark_checks < FLASH_AUTO_HOLD_CHECKS) {
+            return;
+        }
+        s_duty = MIN(s_duty + FLASH_AUTO_STEP_PCT, s_brightness);
+    } else if (need < CONFIG_FLASH_AUTO_OFF_LEVEL && s_duty > 0) {
+        s_duty = s_duty > FLASH_AUTO_STEP_PCT ? s_duty - FLASH_AUTO_STEP_PCT : 0;
+    }
+    s_dark_checks = 0;
+}
+
+static void flash_task(void *arg)
+{
+    while (true) {
+        idle_mgr_stats_t idle;
+        idle_mgr_get_stats(&idle);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (idle.standby) {
+            // Never light an idle camera, ON mode comes back after the wake
+            if (s_mode == FLASH_MODE_AUTO) {
+                s_duty = 0;
+            }
+            set_duty(0);
+        } else {
+            if (s_mode == FLASH_MODE_AUTO) {
+                auto_adjust();
+            }
+            set_duty(s_duty);
+        }
+        xSemaphoreGive(s_lock);
+
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_FLASH_AUTO_PERIOD_MS));
+    }
+}
+
+esp_err_t flash_led_init(void)
+{
+    ledc_timer_config_t timer_conf = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .duty_resolution = LEDC_TIMER_10_BIT,
+        .timer_num = FLASH_LEDC_TIMER,
+        .freq_hz = FLASH_PWM_FREQ_HZ,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ledc_channel_config_t channel_conf = {
+        .gpio_num = CONFIG_FLASH_LED_GPIO,
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .channel = FLASH_LEDC_CHANNEL,
+        .intr_type = LEDC_INTR_DISABLE,
+        .timer_sel = FLASH_LEDC_TIMER,
+        .duty = 0,
+        .hpoint = 0,
+    };
+    esp_err_t err = ledc_timer_config(&timer_conf);
+    if (err == ESP_OK) {
+        err = ledc_channel_config(&channel_conf);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "LEDC setup failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    const esp_timer_create_args_t on_args = {
+        .callback = &pulse_on,
+        .name = "flash_on"
+    };
+    const esp_timer_create_args_t off_args = {
+        .callback = &pulse_off,
+        .name = "flash_off"
+    };
+    err = esp_timer_create(&on_args, &s_on_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_create(&off_args, &s_off_timer);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL ||
+        xTaskCreate(flash_task, "flash", 3072, NULL, 1, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Flash LED on GPIO %d", CONFIG_FLASH_LED_GPIO);
+    return ESP_OK;
+}
+
+void flash_led_set_mode(flash_mode_t mode)
+{
+    if (s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_mode = mode;
+    s_dark_checks = 0;
+    s_duty = mode == FLASH_MODE_ON ? s_brightness : 0;
+    set_duty(s_duty);
+    xSemaphoreGive(s_lock);
+}
+
+void flash_led_set_brightness(uint8_t percent)
+{
+    if (s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_brightness = MIN(percent, 100);
+    if (s_mode == FLASH_MODE_ON || s_duty > s_brightness) {
+        s_duty = s_mode == FLASH_MODE_ON ? s_brightness : MIN(s_duty, s_brightness);
+        set_duty(s_duty);
+    }
+    xSemaphoreGive(s_lock);
+}
+
+camera_fb_t *flash_led_capture(camera_grab_mode_t grab_mode)
+{
+    if (s_lock == NULL) {
+        return esp_camera_fb_get();
+    }
+
+    camera_fb_t *fb = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    int64_t period, t1;
+    if (!measure_frames(&period, &t1)) {
+        // No usable period: light now and take the first frame that started after it
+        ESP_LOGW(TAG, "Frame period unknown, holding the LED on");
+        set_duty(CONFIG_FLASH_PULSE_DUTY_PCT);
+        fb = frame_stamp_fb_get_since(esp_timer_get_time(), FLASH_MAX_SKIP_FRAMES);
+        set_duty(s_duty);
+        if (fb != NULL) {
+            s_stats.pulses++;
+        }
+        xSemaphoreGive(s_lock);
+        return fb;
+    }
+
+    // First predicted edge T0 far enough ahead to arm the timer for it
+    int64_t t0 = t1;
+    while (t0 < esp_timer_get_time() + FLASH_TIMER_LEAD_US) {
+        t0 += period;
+    }
+    t1 = t0 + period;
+    int64_t half_period = period / 2;
+    int64_t now = esp_timer_get_time();
+    esp_timer_start_once(s_on_timer, t0 - now);
+
+    if (grab_mode == CAMERA_GRAB_LATEST) {
+        // The frame started at T1 is read out by the next edge
+        esp_timer_start_once(s_off_timer, t1 + period - now);
+        fb = frame_stamp_fb_get_since(t1 - half_period, FLASH_MAX_SKIP_FRAMES);
+        if (fb != NULL && frame_stamp_capture_us(fb) > t1 + half_period) {
+            // Dropped by the driver, the next frame was not lit: light until one that is
+            esp_camera_fb_return(fb);
+            fb = NULL;
+            s_stats.pulse_misses++;
+            esp_timer_stop(s_off_timer);
+            set_duty(CONFIG_FLASH_PULSE_DUTY_PCT);
+            t1 = esp_timer_get_time() + half_period;
+        }
+    }
+    if (fb == NULL) {
+        // Queued frames are handed out in order: keep the LED on until a lit one arrives
+        fb = frame_stamp_fb_get_since(t1 - half_period, FLASH_MAX_SKIP_FRAMES);
+    }
+    pulse_cancel();
+
+    if (fb != NULL) {
+        s_stats.pulses++;
+    }
+    xSemaphoreGive(s_lock);
+    return fb;
+}
+
+void flash_led_get_stats(flash_led_stats_t *stats)
+{
+    if (s_lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    stats->mode = s_mode;
+    stats->brightness = s_brightness;
+    stats->duty = s_duty;
+    xSemaphoreGive(s_lock);
+}
+
+#else  // CONFIG_FLASH_LED_ENABLED
+
+esp_err_t flash_led_init(void)
+{
+    ESP_LOGI(TAG, "Flash LED disabled");
+    return ESP_OK;
+}
+
+void flash_led_set_mode(flash_mode_t mode)
+{
+}
+
+void flash_led_set_brightness(uint8_t percent)
+{
+}
+
+camera_fb_t *flash_led_capture(camera_grab_mode_t grab_mode)
+{
+    return esp_camera_fb_get();
+}
+
+void flash_led_get_stats(flash_led_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif  // CONFIG_FLASH_LED_ENABLED
+
+bool flash_led_parse_mode(const char *name, flash_mode_t *mode)
+{
+    for (int m = FLASH_MODE_OFF; m <= FLASH_MODE_AUTO; m++) {
+        if (strcmp(name, flash_led_mode_name(m)) == 0) {
+            *mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *flash_led_mode_name(flash_mode_t mode)
+{
+    switch (mode) {
+    case FLASH_MODE_ON:
+        return "on";
+    case FLASH_MODE_AUTO:
+        return "auto";
+    default:
+        return "off";
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * ESP32-CAM 閃光燈控制 (Flash LED)
+ *
+ * - GPIO 4 閃光燈以 LEDC PWM 驅動，可持續照明並調整亮度
+ * - 脈衝模式: 對齊感測器 VSYNC (由影格時間戳記推算)，只在一張影格的曝光期間點亮，
+ *   /capture?flash=1 不需額外清除舊影格
+ * - 自動模式: 依感測器即時 AEC 曝光值與 AGC 增益決定開關與亮度
+ * - 相機待機時自動關閉
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+typedef enum {
+    FLASH_MODE_OFF = 0,
+    FLASH_MODE_ON,          // Continuous illumination at the set brightness
+    FLASH_MODE_AUTO,        // Brightness follows the sensor's AEC / AGC
+} flash_mode_t;
+
+typedef struct {
+    flash_mode_t mode;
+    uint8_t brightness;     // Continuous brightness / auto ceiling, percent
+    uint8_t duty;           // Current output, percent
+    uint8_t light_need;     // Exposure fraction x gain, 0-200 (auto mode input)
+    uint16_t exposure;      // Live AEC exposure in lines
+    uint16_t gain_x16;      // Live AGC gain, 16 = 1x
+    uint32_t pulses;        // Flash captures taken
+    uint32_t pulse_misses;  // Pulsed frame missed, fell back to holding the LED on
+} flash_led_stats_t;
+
+// Configure the LEDC channel and start the auto / standby task
+esp_err_t flash_led_init(void);
+
+void flash_led_set_mode(flash_mode_t mode);
+void flash_led_set_brightness(uint8_t percent);
+
+bool flash_led_parse_mode(const char *name, flash_mode_t *mode);
+const char *flash_led_mode_name(flash_mode_t mode);
+
+// Capture one frame exposed with the flash, returns NULL on failure
+camera_fb_t *flash_led_capture(camera_grab_mode_t grab_mode);
+
+void flash_led_get_stats(flash_led_stats_t *stats);
@@ -0,0 +1,198 @@
+/*
+ * ESP32-CAM 影格時間戳記 (Frame Timestamps)
+ *
+ * esp32-camera 以 esp_timer (開機後微秒) 記錄 fb->timestamp，
+ * 這裡換算成 gettimeofday() 的時間軸，SNTP 同步後即為 Unix 時間。
+ *
+ * 驅動程式沒有公開 VSYNC 計數，序號改由擷取時間換算: 與上一張已編號影格的
+ * 時間差除以量測到的影格週期並四捨五入。序號因此代表感測器影格，而不是
+ * esp_camera_fb_get() 的呼叫次數，被驅動程式丟棄或被其他客戶端取走的影格
+ * 都會在序號上留下缺口。
+ *
+ * 週期只能從實際取得的影格量測: 連續多次出現相同的 n > 1 缺口時視為
+ * 影格率下降 (例如低光源下 AEC 拉長曝光)，改以新的間隔為週期。
+ * 因此固定節奏跳過的影格 (節流的設定檔) 不會被計為缺口。
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <esp_log.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_netif_sntp.h"
+
+#include "frame_stamp.h"
+
+static const char *TAG = "frame_stamp";
+
+// Sensor frame numbering, anchored on the newest stamped frame
+static portMUX_TYPE s_seq_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_anchor_us = 0;
+static uint32_t s_anchor_seq = 0;
+static int32_t s_period_us = 0;     // Measured frame period, 0 until two frames were seen
+static int64_t s_repeat_n = 0;      // Last multi-frame gap and how often it came in a row
+static int s_repeat_count = 0;
+static atomic_bool s_time_synced = false;
+
+#ifdef CONFIG_SNTP_ENABLED
+static void time_sync_cb(struct timeval *tv)
+{
+    atomic_store(&s_time_synced, true);
+    ESP_LOGI(TAG, "Time synchronized: %lld", (long long)tv->tv_sec);
+}
+#endif
+
+esp_err_t frame_stamp_init(void)
+{
+#ifdef CONFIG_SNTP_ENABLED
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(CONFIG_SNTP_SERVER);
+    config.sync_cb = time_sync_cb;
+
+    esp_err_t err = esp_netif_sntp_init(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "SNTP init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "SNTP started (server: %s)", CONFIG_SNTP_SERVER);
+#else
+    ESP_LOGI(TAG, "SNTP disabled, timestamps are relative to boot");
+#endif
+    return ESP_OK;
+}
+
+bool frame_stamp_time_synced(void)
+{
+    return atomic_load(&s_time_synced);
+}
+
+int64_t frame_stamp_capture_us(const camera_fb_t *fb)
+{
+    return (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+}
+
+camera_fb_t *frame_stamp_fb_get_since(int64_t min_us, int max_frames)
+{
+    for (int i = 0; i < max_frames; i++) {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (fb == NULL) {
+            return NULL;
+        }
+        if (frame_stamp_capture_us(fb) >= min_us) {
+            return fb;
+        }
+        esp_camera_fb_return(fb);
+    }
+    return NULL;
+}
+
+#define FRAME_SEQ_RATE_DROP_GAPS    8   // Identical multi-frame gaps in a row that mean a slower sensor
+
+// Sensor frame number for a capture time
+static uint32_t frame_seq(int64_t capture_us)
+{
+    portENTER_CRITICAL(&s_seq_lock);
+    int64_t delta = capture_us - s_anchor_us;
+    int64_t n;
+    if (s_anchor_us == 0 || delta == 0) {
+        n = 0;
+    } else if (s_period_us == 0 || (delta > 0 && delta < (int64_t)s_period_us * 3 / 4)) {
+        // First interval, or the previous estimate spanned several frames
+        s_period_us = (int32_t)(delta > 0 ? delta : -delta);
+        n = delta > 0 ? 1 : -1;
+    } else {
+        n = delta > 0 ? (delta + s_period_us / 2) / s_period_us
+                      : -((-delta + s_period_us / 2) / s_period_us);
+        // The same gap over and over is a lower frame rate, not dropped frames
+        s_repeat_count = n > 1 && n == s_repeat_n ? s_repeat_count + 1 : 0;
+        s_repeat_n = n;
+        if (s_repeat_count >= FRAME_SEQ_RATE_DROP_GAPS) {
+            s_period_us = (int32_t)delta;
+            s_repeat_count = 0;
+            n = 1;
+        } else if (n > 0 && n <= 4) {
+            // Refine the estimate from short gaps, long ones (standby) carry too much rounding
+            s_period_us += (int32_t)((delta / n - s_period_us) / 8);
+        }
+    }
+    uint32_t seq = s_anchor_seq + (uint32_t)n;
+    // Frames stamped out of order (several clients) do not move the anchor back
+    if (s_anchor_us == 0 || delta > 0) {
+        s_anchor_us = capture_us;
+        s_anchor_seq = seq;
+    }
+    portEXIT_CRITICAL(&s_seq_lock);
+    return seq;
+}
+
+void frame_stamp_reset_period(void)
+{
+    portENTER_CRITICAL(&s_seq_lock);
+    s_period_us = 0;
+    s_repeat_count = 0;
+    portEXIT_CRITICAL(&s_seq_lock);
+}
+
+void frame_stamp_take(const camera_fb_t *fb, frame_stamp_t *stamp)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    int64_t now_wall_us = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+    int64_t age_us = esp_timer_get_time() - frame_stamp_capture_us(fb);
+
+    stamp->wall_us = now_wall_us - (age_us > 0 ? age_us : 0);
+    stamp->seq = frame_seq(frame_stamp_capture_us(fb));
+    stamp->synced = atomic_load(&s_time_synced);
+}
+
+int frame_stamp_format_time(const frame_stamp_t *stamp, char *buf, size_t len)
+{
+    return snprintf(buf, len, "%lld.%06ld",
+                    (long long)(stamp->wall_us / 1000000), (long)(stamp->wall_us % 1000000));
+}
+
+size_t frame_stamp_com_offset(const uint8_t *jpg, size_t len)
+{
+    if (len < 4 || jpg[0] != 0xFF || jpg[1] != 0xD8) {
+        return 0;
+    }
+    if (jpg[2] != 0xFF || jpg[3] != 0xE0) {
+        return 2;
+    }
+    if (len < 6) {
+        return 0;
+    }
+    // APP0 length counts its two length bytes but not the marker
+    size_t end = 4 + ((size_t)jpg[4] << 8 | jpg[5]);
+    return end <= len ? end : 0;
+}
+
+size_t frame_stamp_com_segment(const frame_stamp_t *stamp, uint8_t *buf, size_t len)
+{
+#ifdef CONFIG_FRAME_STAMP_JPEG_COMMENT
+    if (len < 4) {
+        return 0;
+    }
+
+    char ts[24];
+    frame_stamp_format_time(stamp, ts, sizeof(ts));
+    int text_len = snprintf((char *)buf + 4, len - 4, "ts=%s;seq=%lu;sync=%d",
+                            ts, (unsigned long)stamp->seq, stamp->synced ? 1 : 0);
+    if (text_len < 0 || (size_t)text_len >= len - 4) {
+        return 0;
+    }
+
+    // Segment length counts the two length bytes but not the marker
+    size_t seg_len = (size_t)text_len + 2;
+    buf[0] = 0xFF;
+    buf[1] = 0xFE;
+    buf[2] = (uint8_t)(seg_len >> 8);
+    buf[3] = (uint8_t)(seg_len & 0xFF);
+    return seg_len + 2;
+#else
+    return 0;
+#endif
+}
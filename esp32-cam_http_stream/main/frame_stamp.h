@@ -0,0 +1,53 @@
+/*
+ * ESP32-CAM 影格時間戳記 (Frame Timestamps)
+ *
+ * - 每個影格附帶擷取時間 (fb->timestamp) 與感測器影格序號
+ * - SNTP 同步後時間戳記為 Unix 時間，可在客戶端計算端到端延遲
+ * - 可選擇在 JPEG 中插入 COM 區段，內容與 HTTP 標頭相同
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+// Largest COM segment produced by frame_stamp_com_segment()
+#define FRAME_STAMP_COM_MAX     64
+
+typedef struct {
+    int64_t wall_us;    // Capture time on the wall clock (Unix time once SNTP synced)
+    uint32_t seq;       // Sensor frame number (gaps = frames this client did not get)
+    bool synced;        // Wall clock synchronized by SNTP
+} frame_stamp_t;
+
+// Start SNTP (call after the network interface is up)
+esp_err_t frame_stamp_init(void);
+
+// True once SNTP has set the clock
+bool frame_stamp_time_synced(void);
+
+// Capture (frame start) time of a frame buffer, esp_timer microseconds
+int64_t frame_stamp_capture_us(const camera_fb_t *fb);
+
+// Get the first frame that started at or after min_us, returning older queued ones
+// Gives up after max_frames frames; returns NULL on failure.
+camera_fb_t *frame_stamp_fb_get_since(int64_t min_us, int max_frames);
+
+// Stamp a frame: converts fb->timestamp to wall-clock time and numbers the sensor frame
+void frame_stamp_take(const camera_fb_t *fb, frame_stamp_t *stamp);
+
+// Forget the measured frame period (call after the sensor frame rate changed)
+void frame_stamp_reset_period(void);
+
+// "seconds.microseconds" for the X-Timestamp header
+int frame_stamp_format_time(const frame_stamp_t *stamp, char *buf, size_t len);
+
+// Where a COM segment may be inserted into a JPEG: after SOI, or after the JFIF APP0
+// segment when present (JFIF requires APP0 right after SOI). 0 if not a JPEG.
+size_t frame_stamp_com_offset(const uint8_t *jpg, size_t len);
+
+// Build a JPEG COM segment (FF FE + length + text), returns its size or 0 if disabled
+size_t frame_stamp_com_segment(const frame_stamp_t *stamp, uint8_t *buf, size_t len);
@@ -0,0 +1,481 @@
+/*
+ * ESP32-CAM 影格串流編碼 (Frame Stream)
+ *
+ * chunk 緩衝區在啟動時一次配置並放入佇列，每個請求取用一個，
+ * 用完歸還；JPEG 解碼用的條帶緩衝區同樣只配置一次。
+ *
+ * 仍有每張影格的配置: esp32-camera 的 frame2jpg_cb() 每次呼叫都會配置
+ * 一條 寬 × 3 bytes 的列緩衝區，以及 jpge 的 MCU 列緩衝區 (H2V2 為
+ * 16 × 寬 × 3 bytes，灰階為 8 × 寬)，編碼完成後釋放。VGA 約 32 KB、
+ * UXGA 約 80 KB，大小隨影格寬度增加。不再配置的是完整的 JPEG 輸出緩衝區。
+ */
+
+#include <string.h>
+#include <esp_log.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "img_converters.h"
+#include "esp_jpg_decode.h"
+
+#include "frame_stream.h"
+#include "frame_stamp.h"
+
+static const char *TAG = "frame_stream";
+
+#define FRAME_STREAM_MAX_WIDTH  1600    // UXGA, widest OV2640 output
+#define FRAME_STREAM_BAND_ROWS  16      // Tallest JPEG MCU
+#define FRAME_STREAM_POOL_WAIT_MS 1000
+#define BMP_HEADER_SIZE         54
+
+static QueueHandle_t s_pool = NULL;         // Free chunk buffers
+static SemaphoreHandle_t s_band_lock = NULL;
+static uint8_t *s_band = NULL;              // RGB888 rows being converted
+
+typedef struct {
+    jpg_chunking_t *out;
+    const camera_fb_t *fb;
+    frame_format_t format;
+    uint16_t width;
+} band_ctx_t;
+
+static void chunk_flush(jpg_chunking_t *j)
+{
+    if (j->fill == 0) {
+        return;
+    }
+    if (j->req != NULL && j->res == ESP_OK) {
+        j->res = httpd_resp_send_chunk(j->req, (const char *)j->buf, j->fill);
+    }
+    j->fill = 0;
+}
+
+static void chunk_write(jpg_chunking_t *j, const uint8_t *data, size_t len)
+{
+    j->len += len;
+    while (len > 0 && j->res == ESP_OK) {
+        size_t n = CONFIG_FRAME_STREAM_CHUNK_SIZE - j->fill;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(j->buf + j->fill, data, n);
+        j->fill += n;
+        data += n;
+        len -= n;
+        if (j->fill == CONFIG_FRAME_STREAM_CHUNK_SIZE) {
+            chunk_flush(j);
+        }
+    }
+}
+
+static esp_err_t chunk_begin(jpg_chunking_t *j, httpd_req_t *req)
+{
+    memset(j, 0, sizeof(*j));
+    j->req = req;
+    if (xQueueReceive(s_pool, &j->buf, pdMS_TO_TICKS(FRAME_STREAM_POOL_WAIT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "No free chunk buffer");
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t chunk_end(jpg_chunking_t *j)
+{
+    chunk_flush(j);
+    xQueueSend(s_pool, &j->buf, 0);
+    j->buf = NULL;
+    return j->res;
+}
+
+// frame2jpg_cb() output callback
+static size_t jpg_encode_chunk(void *arg, size_t index, const void *data, size_t len)
+{
+    jpg_chunking_t *j = (jpg_chunking_t *)arg;
+    const uint8_t *p = (const uint8_t *)data;
+
+    // jpge writes SOI and the JFIF APP0 segment in its first output block
+    size_t offset = index == 0 && j->com_len > 0 ? frame_stamp_com_offset(p, len) : 0;
+    if (offset > 0) {
+        chunk_write(j, p, offset);
+        chunk_write(j, j->com, j->com_len);
+        chunk_write(j, p + offset, len - offset);
+    } else {
+        chunk_write(j, p, len);
+    }
+    // Returning 0 aborts the encode, a disconnected client costs no more than this block
+    return j->res == ESP_OK ? len : 0;
+}
+
+// Convert one RGB888 row to the output format, straight into the chunk buffer
+static void emit_rgb_row(jpg_chunking_t *j, const uint8_t *rgb, uint16_t width, frame_format_t format)
+{
+    for (uint16_t x = 0; x < width && j->res == ESP_OK; x++, rgb += 3) {
+        if (j->fill + 3 > CONFIG_FRAME_STREAM_CHUNK_SIZE) {
+            chunk_flush(j);
+        }
+        uint8_t *o = j->buf + j->fill;
+        switch (format) {
+        case FRAME_FORMAT_RGB565: {
+            uint16_t c = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+            o[0] = c >> 8;
+            o[1] = c & 0xFF;
+            j->fill += 2;
+            break;
+        }
+        case FRAME_FORMAT_GRAY:
+            o[0] = (rgb[0] * 77 + rgb[1] * 150 + rgb[2] * 29) >> 8;
+            j->fill += 1;
+            break;
+        default:    // BMP stores BGR
+            o[0] = rgb[2];
+            o[1] = rgb[1];
+            o[2] = rgb[0];
+            j->fill += 3;
+            break;
+        }
+    }
+    j->len += (size_t)width * (format == FRAME_FORMAT_RGB565 ? 2 : format == FRAME_FORMAT_GRAY ? 1 : 3);
+
+    // BMP rows are padded to 4 bytes
+    if (format == FRAME_FORMAT_BMP) {
+        static const uint8_t pad[3] = {0};
+        size_t pad_len = (4 - (width * 3) % 4) % 4;
+        if (pad_len) {
+            chunk_write(j, pad, pad_len);
+        }
+    }
+}
+
+static void put_le(uint8_t *p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+static void emit_bmp_header(jpg_chunking_t *j, uint16_t width, uint16_t height)
+{
+    uint8_t h[BMP_HEADER_SIZE] = {'B', 'M'};
+    uint32_t stride = (width * 3 + 3) & ~3u;
+    uint32_t image_size = stride * height;
+
+    put_le(h + 2, BMP_HEADER_SIZE + image_size, 4);    // File size
+    put_le(h + 10, BMP_HEADER_SIZE, 4);                // Pixel data offset
+    put_le(h + 14, 40, 4);                             // BITMAPINFOHEADER size
+    put_le(h + 18, width, 4);
+    put_le(h + 22, (uint32_t)(-(int32_t)height), 4);   // Negative height: top-down rows
+    put_le(h + 26, 1, 2);                              // Planes
+    put_le(h + 28, 24, 2);                             // Bits per pixel
+    put_le(h + 34, image_size, 4);
+    chunk_write(j, h, sizeof(h));
+}
+
+// esp_jpg_decode() input callback
+static size_t jpg_read(void *arg, size_t index, uint8_t *buf, size_t len)
+{
+    const camera_fb_t *fb = ((band_ctx_t *)arg)->fb;
+    if (index >= fb->len) {
+        return 0;
+    }
+    if (len > fb->len - index) {
+        len = fb->len - index;
+    }
+    if (buf) {
+        memcpy(buf, fb->buf + index, len);
+    }
+    return len;
+}
+
+// esp_jpg_decode() output callback, called per MCU block in raster order
+static bool jpg_write_band(void *arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data)
+{
+    band_ctx_t *ctx = (band_ctx_t *)arg;
+
+    if (data == NULL) {
+        // Start (x == 0 && y == 0) reports the image size, other calls mark the end
+        if (x == 0 && y == 0) {
+            ctx->width = w;
+            return w <= FRAME_STREAM_MAX_WIDTH;
+        }
+        return true;
+    }
+    if (h > FRAME_STREAM_BAND_ROWS || x + w > ctx->width) {
+        return false;
+    }
+
+    size_t stride = (size_t)ctx->width * 3;
+    for (uint16_t row = 0; row < h; row++) {
+        memcpy(s_band + row * stride + x * 3, data + row * w * 3, w * 3);
+    }
+
+    // Last block of the MCU row completes the band
+    if (x + w >= ctx->width) {
+        for (uint16_t row = 0; row < h; row++) {
+            emit_rgb_row(ctx->out, s_band + row * stride, ctx->width, ctx->format);
+        }
+    }
+    return ctx->out->res == ESP_OK;
+}
+
+// Expand one row of a raw sensor frame to RGB888
+static bool raw_row_to_rgb(const camera_fb_t *fb, uint16_t y, uint8_t *rgb)
+{
+    const uint8_t *src = fb->buf;
+    switch (fb->format) {
+    case PIXFORMAT_RGB565:
+        src += (size_t)y * fb->width * 2;
+        for (uint16_t x = 0; x < fb->width; x++, src += 2, rgb += 3) {
+            uint16_t c = (src[0] << 8) | src[1];
+            rgb[0] = (c >> 8) & 0xF8;
+            rgb[1] = (c >> 3) & 0xFC;
+            rgb[2] = (c << 3) & 0xF8;
+        }
+        return true;
+    case PIXFORMAT_GRAYSCALE:
+        src += (size_t)y * fb->width;
+        for (uint16_t x = 0; x < fb->width; x++, rgb += 3) {
+            rgb[0] = rgb[1] = rgb[2] = src[x];
+        }
+        return true;
+    case PIXFORMAT_RGB888:
+        // The driver delivers BGR
+        src += (size_t)y * fb->width * 3;
+        for (uint16_t x = 0; x < fb->width; x++, src += 3, rgb += 3) {
+            rgb[0] = src[2];
+            rgb[1] = src[1];
+            rgb[2] = src[0];
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+esp_err_t frame_stream_init(void)
+{
+    s_pool = xQueueCreate(CONFIG_FRAME_STREAM_POOL_SIZE, sizeof(uint8_t *));
+    s_band_lock = xSemaphoreCreateMutex();
+    s_band = heap_caps_malloc(FRAME_STREAM_MAX_WIDTH * FRAME_STREAM_BAND_ROWS * 3, MALLOC_CAP_SPIRAM);
+    if (s_pool == NULL || s_band_lock == NULL || s_band == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate frame stream buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < CONFIG_FRAME_STREAM_POOL_SIZE; i++) {
+        uint8_t *buf = malloc(CONFIG_FRAME_STREAM_CHUNK_SIZE);
+        if (buf == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate chunk buffer %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        xQueueSend(s_pool, &buf, 0);
+    }
+
+    ESP_LOGI(TAG, "Chunk pool: %d x %d bytes", CONFIG_FRAME_STREAM_POOL_SIZE, CONFIG_FRAME_STREAM_CHUNK_SIZE);
+    return ESP_OK;
+}
+
+size_t frame_stream_encoder_alloc(uint16_t width, pixformat_t format, size_t *line, size_t *mcu_rows)
+{
+    // Mirrors convert_image() in esp32-camera to_jpg.cpp and jpeg_encoder::init() in jpge.cpp
+    if (format == PIXFORMAT_GRAYSCALE) {
+        *line = width;
+        *mcu_rows = (size_t)((width + 7) & ~7) * 8;
+    } else {
+        *line = (size_t)width * 3;
+        *mcu_rows = (size_t)((width + 15) & ~15) * 3 * 16;
+    }
+    return *line + *mcu_rows;
+}
+
+esp_err_t frame_stream_send_jpeg(httpd_req_t *req, camera_fb_t *fb, uint8_t quality,
+                                 const uint8_t *com, size_t com_len, size_t *out_len)
+{
+    jpg_chunking_t j;
+    esp_err_t err = chunk_begin(&j, req);
+    if (err != ESP_OK) {
+        return err;
+    }
+    j.com = com;
+    j.com_len = com_len;
+
+    bool encoded = frame2jpg_cb(fb, quality, jpg_encode_chunk, &j);
+    err = chunk_end(&j);
+    if (out_len) {
+        *out_len = j.len;
+    }
+    if (err != ESP_OK) {
+        // Send failed, the encoder was stopped on purpose
+        return err;
+    }
+    if (!encoded) {
+        ESP_LOGE(TAG, "JPEG compression failed");
+        return ESP_FAIL;
+    }
+    return err;
+}
+
+esp_err_t frame_stream_send_raw(httpd_req_t *req, camera_fb_t *fb, frame_format_t format)
+{
+    // Sensor already produces the requested layout
+    if ((format == FRAME_FORMAT_RGB565 && fb->format == PIXFORMAT_RGB565) ||
+        (format == FRAME_FORMAT_GRAY && fb->format == PIXFORMAT_GRAYSCALE)) {
+        return httpd_resp_send_chunk(req, (const char *)fb->buf, fb->len);
+    }
+
+    jpg_chunking_t j;
+    esp_err_t err = chunk_begin(&j, req);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (format == FRAME_FORMAT_BMP) {
+        emit_bmp_header(&j, fb->width, fb->height);
+    }
+
+    xSemaphoreTake(s_band_lock, portMAX_DELAY);
+    if (fb->format == PIXFORMAT_JPEG) {
+        band_ctx_t ctx = {
+            .out = &j,
+            .fb = fb,
+            .format = format,
+        };
+        if (esp_jpg_decode(fb->len, JPG_SCALE_NONE, jpg_read, jpg_write_band, &ctx) != ESP_OK &&
+            j.res == ESP_OK) {
+            ESP_LOGE(TAG, "JPEG decode failed");
+            j.res = ESP_FAIL;
+        }
+    } else if (fb->width <= FRAME_STREAM_MAX_WIDTH) {
+        for (uint16_t y = 0; y < fb->height && j.res == ESP_OK; y++) {
+            if (!raw_row_to_rgb(fb, y, s_band)) {
+                j.res = ESP_ERR_NOT_SUPPORTED;
+                break;
+            }
+            emit_rgb_row(&j, s_band, fb->width, format);
+        }
+    } else {
+        j.res = ESP_ERR_NOT_SUPPORTED;
+    }
+    xSemaphoreGive(s_band_lock);
+
+    return chunk_end(&j);
+}
+
+bool frame_stream_parse_format(const char *name, frame_format_t *format)
+{
+    for (int f = FRAME_FORMAT_JPEG; f <= FRAME_FORMAT_BMP; f++) {
+        if (strcmp(name, frame_stream_format_name(f)) == 0) {
+            *format = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *frame_stream_content_type(frame_format_t format)
+{
+    switch (format) {
+    case FRAME_FORMAT_JPEG:
+        return "image/jpeg";
+    case FRAME_FORMAT_BMP:
+        return "image/bmp";
+    default:
+        return "application/octet-stream";
+    }
+}
+
+const char *frame_stream_format_name(frame_format_t format)
+{
+    switch (format) {
+    case FRAME_FORMAT_RGB565:
+        return "rgb565";
+    case FRAME_FORMAT_GRAY:
+        return "gray";
+    case FRAME_FORMAT_BMP:
+        return "bmp";
+    default:
+        return "jpeg";
+    }
+}
+
+// Peak heap use since the last heap_caps_monitor_local_minimum_free_size_start()
+static uint32_t heap_peak_since(size_t free_before)
+{
+    size_t min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    return free_before > min_free ? free_before - min_free : 0;
+}
+
+esp_err_t frame_stream_bench(uint32_t iterations, uint8_t quality, frame_stream_bench_t *result)
+{
+    camera_fb_t fb = {
+        .width = 640,
+        .height = 480,
+        .format = PIXFORMAT_RGB565,
+        .len = 640 * 480 * 2,
+    };
+    fb.buf = heap_caps_malloc(fb.len, MALLOC_CAP_SPIRAM);
+    if (fb.buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Gradient with some texture so the encoder does real work
+    for (size_t y = 0, i = 0; y < fb.height; y++) {
+        for (size_t x = 0; x < fb.width; x++, i += 2) {
+            uint16_t c = ((x * 31 / fb.width) << 11) | ((y * 63 / fb.height) << 5) | ((x ^ y) & 31);
+            fb.buf[i] = c >> 8;
+            fb.buf[i + 1] = c & 0xFF;
+        }
+    }
+
+    memset(result, 0, sizeof(*result));
+    result->width = fb.width;
+    result->height = fb.height;
+    result->iterations = iterations;
+    frame_stream_encoder_alloc(fb.width, fb.format, &result->enc_line_bytes, &result->enc_mcu_bytes);
+    esp_err_t err = ESP_OK;
+
+    // Current approach: frame2jpg() mallocs a full output buffer per frame
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    heap_caps_monitor_local_minimum_free_size_start();
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint8_t *jpg = NULL;
+        size_t jpg_len = 0;
+        if (!frame2jpg(&fb, quality, &jpg, &jpg_len)) {
+            err = ESP_FAIL;
+            break;
+        }
+        result->jpeg_len = jpg_len;
+        free(jpg);
+    }
+    result->alloc_frame_us = (esp_timer_get_time() - start) / iterations;
+    result->alloc_peak_bytes = heap_peak_since(free_before);
+    heap_caps_monitor_local_minimum_free_size_stop();
+
+    // Streaming encode into a pooled chunk buffer, output discarded
+    jpg_chunking_t j;
+    if (err == ESP_OK) {
+        err = chunk_begin(&j, NULL);
+    }
+    if (err == ESP_OK) {
+        free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        heap_caps_monitor_local_minimum_free_size_start();
+        start = esp_timer_get_time();
+        for (uint32_t i = 0; i < iterations; i++) {
+            j.len = 0;
+            if (!frame2jpg_cb(&fb, quality, jpg_encode_chunk, &j)) {
+                err = ESP_FAIL;
+                break;
+            }
+            chunk_flush(&j);
+        }
+        result->stream_frame_us = (esp_timer_get_time() - start) / iterations;
+        result->stream_peak_bytes = heap_peak_since(free_before);
+        heap_caps_monitor_local_minimum_free_size_stop();
+        chunk_end(&j);
+    }
+
+    free(fb.buf);
+    return err;
+}
@@ -0,0 +1,70 @@
+/*
+ * ESP32-CAM 影格串流編碼 (Frame Stream)
+ *
+ * - 非 JPEG 影格以 frame2jpg_cb 邊編碼邊送出，輸出寫入預先配置的
+ *   固定大小 chunk 緩衝區池，填滿即以 HTTP chunk 送出，不再每張影格配置完整輸出緩衝區
+ *   (編碼器本身的列緩衝區仍每張配置，見 frame_stream.c)
+ * - /capture?format=rgb565|gray|bmp: JPEG 影格以回呼式解碼逐條帶 (band)
+ *   轉換，原始格式影格直接逐列轉換，同樣經由 chunk 緩衝區送出
+ * - 提供編碼基準測試: 比較 frame2jpg() 與串流編碼的峰值記憶體與每張時間
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "esp_http_server.h"
+
+// Output state shared by the encoder / decoder callbacks
+typedef struct {
+    httpd_req_t *req;       // NULL discards output (benchmark sink)
+    size_t len;             // Bytes produced so far
+    uint8_t *buf;           // Pooled chunk buffer
+    size_t fill;
+    const uint8_t *com;     // Optional COM segment, inserted after JFIF APP0 (or SOI)
+    size_t com_len;
+    esp_err_t res;
+} jpg_chunking_t;
+
+typedef enum {
+    FRAME_FORMAT_JPEG = 0,
+    FRAME_FORMAT_RGB565,    // Big-endian, as produced by the sensor
+    FRAME_FORMAT_GRAY,      // 8-bit luma
+    FRAME_FORMAT_BMP,       // 24-bit top-down bitmap
+} frame_format_t;
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint32_t iterations;
+    uint32_t jpeg_len;
+    uint32_t alloc_frame_us;    // frame2jpg() average per frame
+    uint32_t alloc_peak_bytes;  // Peak heap used by frame2jpg()
+    uint32_t stream_frame_us;   // frame2jpg_cb() into the chunk pool, average per frame
+    uint32_t stream_peak_bytes; // Pool is preallocated, so this is the encoder's own per-frame use
+    size_t enc_line_bytes;      // Allocated by frame2jpg_cb() on every call
+    size_t enc_mcu_bytes;
+} frame_stream_bench_t;
+
+// Allocate the chunk pool and decode band buffer (call once at startup)
+esp_err_t frame_stream_init(void);
+
+// Heap the esp32-camera encoder allocates (and frees) on every frame2jpg_cb() call
+// at this width: the input line buffer plus the jpge MCU row buffers.
+size_t frame_stream_encoder_alloc(uint16_t width, pixformat_t format, size_t *line, size_t *mcu_rows);
+
+// Encode a non-JPEG frame and send it as HTTP chunks, *out_len gets the JPEG size
+esp_err_t frame_stream_send_jpeg(httpd_req_t *req, camera_fb_t *fb, uint8_t quality,
+                                 const uint8_t *com, size_t com_len, size_t *out_len);
+
+// Send a frame converted to a raw format as HTTP chunks (response not terminated)
+esp_err_t frame_stream_send_raw(httpd_req_t *req, camera_fb_t *fb, frame_format_t format);
+
+bool frame_stream_parse_format(const char *name, frame_format_t *format);
+const char *frame_stream_content_type(frame_format_t format);
+const char *frame_stream_format_name(frame_format_t format);
+
+// Encode a synthetic VGA RGB565 frame with both approaches
+esp_err_t frame_stream_bench(uint32_t iterations, uint8_t quality, frame_stream_bench_t *result);
@@ -0,0 +1,218 @@
+/*
+ * ESP32-CAM 閒置省電管理 (Idle Manager)
+ *
+ * OV2640 在 PWDN 拉高時進入待機並保留暫存器內容，
+ * 因此喚醒只需釋放 PWDN、恢復 XCLK、等待感測器穩定。
+ */
+
+#include <string.h>
+#include <esp_log.h>
+#include <esp_wifi.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+
+#include "idle_mgr.h"
+
+static const char *TAG = "idle_mgr";
+
+#ifdef CONFIG_IDLE_POWERDOWN_ENABLED
+
+#define IDLE_CHECK_PERIOD_US    (1000 * 1000)
+
+static SemaphoreHandle_t s_lock = NULL;
+static esp_timer_handle_t s_timer = NULL;
+static int s_pin_pwdn = -1;
+static ledc_timer_t s_xclk_timer;
+static wifi_ps_type_t s_active_ps = WIFI_PS_MIN_MODEM;
+
+static int s_users = 0;             // Requests currently using the camera
+static int64_t s_last_use_us = 0;
+static int64_t s_wake_us = 0;       // Time of the last wake, frames older than this are stale
+static int64_t s_wake_pending_us = 0; // Non-zero until the first frame after a wake
+static idle_mgr_stats_t s_stats;
+
+static void enter_standby(void)
+{
+    if (s_pin_pwdn >= 0) {
+        gpio_set_level(s_pin_pwdn, 1);
+    }
+    ledc_timer_pause(LEDC_LOW_SPEED_MODE, s_xclk_timer);
+
+#if defined(CONFIG_IDLE_WIFI_PS_MIN_MODEM)
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+#elif defined(CONFIG_IDLE_WIFI_PS_MAX_MODEM)
+    esp_wifi_set_ps(WIFI_PS_MAX_MODEM);
+#endif
+
+    s_stats.standby = true;
+    s_stats.standby_count++;
+    ESP_LOGI(TAG, "Camera idle for %d s, entering standby", CONFIG_IDLE_TIMEOUT_S);
+}
+
+static void leave_standby(void)
+{
+    int64_t start = esp_timer_get_time();
+
+#if defined(CONFIG_IDLE_WIFI_PS_MIN_MODEM) || defined(CONFIG_IDLE_WIFI_PS_MAX_MODEM)
+    esp_wifi_set_ps(s_active_ps);
+#endif
+    ledc_timer_resume(LEDC_LOW_SPEED_MODE, s_xclk_timer);
+    if (s_pin_pwdn >= 0) {
+        gpio_set_level(s_pin_pwdn, 0);
+    }
+
+    // Sensor registers were kept, only wait for the output to restart
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_IDLE_WAKE_SETTLE_MS));
+
+    s_wake_us = start;
+    s_wake_pending_us = start;
+    s_stats.standby = false;
+    s_stats.wake_count++;
+}
+
+static void idle_check(void *arg)
+{
+    // Runs in the shared esp_timer task: never wait out a wake-up, the next tick checks again
+    if (xSemaphoreTake(s_lock, 0) != pdTRUE) {
+        return;
+    }
+    if (!s_stats.standby && s_users == 0 &&
+        esp_timer_get_time() - s_last_use_us > (int64_t)CONFIG_IDLE_TIMEOUT_S * 1000000) {
+        enter_standby();
+    }
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t idle_mgr_init(const camera_config_t *config)
+{
+    s_pin_pwdn = config->pin_pwdn;
+    s_xclk_timer = config->ledc_timer;
+    s_last_use_us = esp_timer_get_time();
+    esp_wifi_get_ps(&s_active_ps);
+
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = idle_check,
+        .name = "idle_check",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &s_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(s_timer, IDLE_CHECK_PERIOD_US);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start idle timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "Idle power-down after %d s", CONFIG_IDLE_TIMEOUT_S);
+    return ESP_OK;
+}
+
+void idle_mgr_acquire(void)
+{
+    if (s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_users++;
+    s_last_use_us = esp_timer_get_time();
+    if (s_stats.standby) {
+        leave_standby();
+    }
+    xSemaphoreGive(s_lock);
+}
+
+void idle_mgr_release(void)
+{
+    if (s_lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_users > 0) {
+        s_users--;
+    }
+    s_last_use_us = esp_timer_get_time();
+    xSemaphoreGive(s_lock);
+}
+
+bool idle_mgr_frame_is_stale(const camera_fb_t *fb)
+{
+    if (s_lock == NULL) {
+        return false;
+    }
+    int64_t capture_us = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool stale = capture_us < s_wake_us;
+    xSemaphoreGive(s_lock);
+    return stale;
+}
+
+void idle_mgr_frame_ready(void)
+{
+    if (s_lock == NULL || s_wake_pending_us == 0) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_wake_pending_us != 0) {
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - s_wake_pending_us);
+        s_wake_pending_us = 0;
+        s_stats.last_wake_us = elapsed;
+        if (elapsed > s_stats.max_wake_us) {
+            s_stats.max_wake_us = elapsed;
+        }
+        ESP_LOGI(TAG, "Wake to first frame: %lu us", (unsigned long)elapsed);
+    }
+    xSemaphoreGive(s_lock);
+}
+
+void idle_mgr_get_stats(idle_mgr_stats_t *stats)
+{
+    if (s_lock == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
+
+#else  // CONFIG_IDLE_POWERDOWN_ENABLED
+
+esp_err_t idle_mgr_init(const camera_config_t *config)
+{
+    ESP_LOGI(TAG, "Idle power-down disabled");
+    return ESP_OK;
+}
+
+void idle_mgr_acquire(void)
+{
+}
+
+void idle_mgr_release(void)
+{
+}
+
+bool idle_mgr_frame_is_stale(const camera_fb_t *fb)
+{
+    return false;
+}
+
+void idle_mgr_frame_ready(void)
+{
+}
+
+void idle_mgr_get_stats(idle_mgr_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif  // CONFIG_IDLE_POWERDOWN_ENABLED
@@ -0,0 +1,41 @@
+/*
+ * ESP32-CAM 閒置省電管理 (Idle Manager)
+ *
+ * - 一段時間沒有 /stream 或 /capture 請求後，以 PWDN 讓感測器待機、
+ *   暫停 XCLK，並開啟 WiFi modem sleep
+ * - 第一個請求到來時喚醒: 只釋放 PWDN 與恢復 XCLK，感測器暫存器在
+ *   待機期間保留，不需重新 esp_camera_init
+ * - 記錄喚醒到第一張影格的時間，於 /status 顯示
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+typedef struct {
+    bool standby;               // Sensor currently powered down
+    uint32_t standby_count;     // Times the idle timeout put the camera in standby
+    uint32_t wake_count;        // Times a request woke the camera
+    uint32_t last_wake_us;      // Wake to first frame, most recent
+    uint32_t max_wake_us;       // Wake to first frame, worst case
+} idle_mgr_stats_t;
+
+// Start the idle timer (call after esp_camera_init)
+esp_err_t idle_mgr_init(const camera_config_t *config);
+
+// A request needs the camera: wakes it if in standby
+void idle_mgr_acquire(void);
+
+// The request is done with the camera, restarts the idle countdown
+void idle_mgr_release(void);
+
+// True if the frame was captured before the last wake and should be skipped
+bool idle_mgr_frame_is_stale(const camera_fb_t *fb);
+
+// Report that a fresh frame was obtained, completes the wake latency measurement
+void idle_mgr_frame_ready(void);
+
+void idle_mgr_get_stats(idle_mgr_stats_t *stats);
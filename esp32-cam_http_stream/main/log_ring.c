@@ -0,0 +1,254 @@
+/*
+ * ESP32-CAM 非同步日誌 (Log Ring Buffer)
+ *
+ * 多寫入者 / 單一讀取者環形緩衝區:
+ * - 寫入者以 atomic fetch_add 取得序號，寫完後發佈該 slot 的序號
+ * - drain 任務依序號讀取並輸出到 UART，落後太多時計入 overwritten
+ * - /logs 讀取時以前後兩次序號比對排除寫入中的 slot (seqlock)
+ */
+
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "log_ring.h"
+
+static const char *TAG = "log_ring";
+
+#ifdef CONFIG_LOG_RING_ENABLED
+
+#define RING_SIZE   CONFIG_LOG_RING_SIZE
+
+typedef struct {
+    atomic_uint seq;        // Entry sequence + 1 once published, 0 while being written
+    log_ring_entry_t entry;
+} log_slot_t;
+
+static log_slot_t *s_ring = NULL;
+static atomic_uint s_head = 0;          // Next sequence to hand out
+static atomic_uint s_overwritten = 0;
+static atomic_uint s_suppressed = 0;
+
+typedef enum {
+    SLOT_OK,
+    SLOT_PENDING,   // Writer has not published this sequence yet
+    SLOT_LOST,      // Slot already reused by a newer sequence
+} slot_state_t;
+
+static slot_state_t read_slot(uint32_t seq, log_ring_entry_t *out)
+{
+    log_slot_t *slot = &s_ring[seq % RING_SIZE];
+    uint32_t before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+    if (before != seq + 1) {
+        if (before == 0 || (int32_t)(before - (seq + 1)) < 0) {
+            return SLOT_PENDING;
+        }
+        return SLOT_LOST;
+    }
+
+    memcpy(out, &slot->entry, sizeof(*out));
+    atomic_thread_fence(memory_order_acquire);
+
+    if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != before) {
+        return SLOT_LOST;
+    }
+    return SLOT_OK;
+}
+
+static char level_letter(esp_log_level_t level)
+{
+    switch (level) {
+    case ESP_LOG_ERROR:   return 'E';
+    case ESP_LOG_WARN:    return 'W';
+    case ESP_LOG_INFO:    return 'I';
+    case ESP_LOG_DEBUG:   return 'D';
+    default:              return 'V';
+    }
+}
+
+// Low priority task printing ring entries to UART
+static void log_ring_drain_task(void *arg)
+{
+    log_ring_entry_t entry;
+    uint32_t tail = 0;
+
+    while (true) {
+        uint32_t head = atomic_load(&s_head);
+
+        while (tail != head) {
+            if (head - tail > RING_SIZE) {
+                atomic_fetch_add(&s_overwritten, head - tail - RING_SIZE);
+                tail = head - RING_SIZE;
+            }
+
+            slot_state_t state = read_slot(tail, &entry);
+            if (state == SLOT_PENDING) {
+                break;  // Retry on the next round
+            }
+            if (state == SLOT_OK) {
+                esp_log_write(entry.level, entry.tag, "%c (%lu) %s: %s\n",
+                              level_letter(entry.level), (unsigned long)(entry.time_us / 1000),
+                              entry.tag, entry.msg);
+            } else {
+                atomic_fetch_add(&s_overwritten, 1);
+            }
+            tail++;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_LOG_RING_DRAIN_PERIOD_MS));
+    }
+}
+
+esp_err_t log_ring_init(void)
+{
+    if (s_ring != NULL) {
+        return ESP_OK;
+    }
+
+    s_ring = heap_caps_calloc(RING_SIZE, sizeof(log_slot_t), MALLOC_CAP_SPIRAM);
+    if (s_ring == NULL) {
+        s_ring = heap_caps_calloc(RING_SIZE, sizeof(log_slot_t), MALLOC_CAP_8BIT);
+    }
+    if (s_ring == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate log ring (%d entries)", RING_SIZE);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(log_ring_drain_task, "log_drain", 3072, NULL,
+                    CONFIG_LOG_RING_DRAIN_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Log ring ready: %d entries, rate limit %d ms",
+             RING_SIZE, CONFIG_LOG_RING_RATE_LIMIT_MS);
+    return ESP_OK;
+}
+
+void log_ring_write(log_ring_site_t *site, esp_log_level_t level, const char *tag,
+                    const char *fmt, ...)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t suppressed = 0;
+
+    if (site != NULL) {
+        // Claim the slot with a CAS so only one of several racing tasks records the message.
+        // Only a deadline at most one period ahead suppresses, a stale one left before the
+        // 32-bit millisecond clock wrapped does not.
+        uint32_t now_ms = (uint32_t)(now / 1000);
+        uint32_t next_ms = atomic_load(&site->next_ms);
+        do {
+            if ((uint32_t)(next_ms - now_ms) - 1 < (uint32_t)CONFIG_LOG_RING_RATE_LIMIT_MS) {
+                atomic_fetch_add(&site->suppressed, 1);
+                atomic_fetch_add(&s_suppressed, 1);
+                return;
+            }
+        } while (!atomic_compare_exchange_weak(&site->next_ms, &next_ms,
+                                               now_ms + CONFIG_LOG_RING_RATE_LIMIT_MS));
+        suppressed = atomic_exchange(&site->suppressed, 0);
+    }
+
+    char msg[LOG_RING_MSG_LEN];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    if (suppressed > 0 && len >= 0 && len < (int)sizeof(msg)) {
+        snprintf(msg + len, sizeof(msg) - len, " (%lu suppressed)", (unsigned long)suppressed);
+    }
+
+    // Not initialized yet, log synchronously
+    if (s_ring == NULL) {
+        esp_log_write(level, tag, "%c (%lu) %s: %s\n", level_letter(level),
+                      (unsigned long)(now / 1000), tag, msg);
+        return;
+    }
+
+    uint32_t seq = atomic_fetch_add(&s_head, 1);
+    log_slot_t *slot = &s_ring[seq % RING_SIZE];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->entry.seq = seq;
+    slot->entry.time_us = now;
+    slot->entry.level = level;
+    strlcpy(slot->entry.tag, tag, sizeof(slot->entry.tag));
+    strlcpy(slot->entry.msg, msg, sizeof(slot->entry.msg));
+
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_release);
+}
+
+uint32_t log_ring_head(void)
+{
+    return atomic_load(&s_head);
+}
+
+size_t log_ring_capacity(void)
+{
+    return RING_SIZE;
+}
+
+bool log_ring_read(uint32_t seq, log_ring_entry_t *entry)
+{
+    if (s_ring == NULL) {
+        return false;
+    }
+    return read_slot(seq, entry) == SLOT_OK;
+}
+
+void log_ring_get_stats(log_ring_stats_t *stats)
+{
+    stats->written = atomic_load(&s_head);
+    stats->overwritten = atomic_load(&s_overwritten);
+    stats->suppressed = atomic_load(&s_suppressed);
+}
+
+#else  // CONFIG_LOG_RING_ENABLED
+
+esp_err_t log_ring_init(void)
+{
+    ESP_LOGI(TAG, "Log ring disabled, logging synchronously");
+    return ESP_OK;
+}
+
+void log_ring_write(log_ring_site_t *site, esp_log_level_t level, const char *tag,
+                    const char *fmt, ...)
+{
+    char msg[LOG_RING_MSG_LEN];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+    esp_log_write(level, tag, "%s: %s\n", tag, msg);
+}
+
+uint32_t log_ring_head(void)
+{
+    return 0;
+}
+
+size_t log_ring_capacity(void)
+{
+    return 0;
+}
+
+bool log_ring_read(uint32_t seq, log_ring_entry_t *entry)
+{
+    return false;
+}
+
+void log_ring_get_stats(log_ring_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif  // CONFIG_LOG_RING_ENABLED
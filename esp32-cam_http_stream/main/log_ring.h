@@ -0,0 +1,75 @@
+/*
+ * ESP32-CAM 非同步日誌 (Log Ring Buffer)
+ *
+ * - 無鎖環形緩衝區，熱路徑只做格式化與寫入，不經 UART
+ * - 低優先權任務負責把日誌輸出到 UART
+ * - 每個呼叫點獨立限速，並統計被抑制的次數
+ * - /logs 端點可透過 HTTP 讀取最近的日誌
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#define LOG_RING_TAG_LEN    16
+#define LOG_RING_MSG_LEN    128
+
+// Per call-site rate limit state, one static instance per LOG_RING_x() use
+// Shared by every task that reaches the call site, so both fields are atomic.
+typedef struct {
+    atomic_uint next_ms;    // Earliest time (ms since boot, wrapping) the next message may be recorded
+    atomic_uint suppressed; // Messages dropped by the rate limit since the last one
+} log_ring_site_t;
+
+typedef struct {
+    uint32_t seq;
+    int64_t time_us;
+    esp_log_level_t level;
+    char tag[LOG_RING_TAG_LEN];
+    char msg[LOG_RING_MSG_LEN];
+} log_ring_entry_t;
+
+typedef struct {
+    uint32_t written;       // Entries written to the ring
+    uint32_t overwritten;   // Entries lost before the drain task printed them
+    uint32_t suppressed;    // Messages dropped by per-site rate limits
+} log_ring_stats_t;
+
+// Start the drain task
+esp_err_t log_ring_init(void);
+
+// Record a message, site may be NULL to skip rate limiting
+void log_ring_write(log_ring_site_t *site, esp_log_level_t level, const char *tag,
+                    const char *fmt, ...) __attribute__((format(printf, 4, 5)));
+
+// Sequence number the next entry will get (= total entries written)
+uint32_t log_ring_head(void);
+
+// Number of entries the ring can hold
+size_t log_ring_capacity(void);
+
+// Copy entry seq, false if it was never written or has been overwritten
+bool log_ring_read(uint32_t seq, log_ring_entry_t *entry);
+
+void log_ring_get_stats(log_ring_stats_t *stats);
+
+#ifdef CONFIG_LOG_RING_ENABLED
+#define LOG_RING_LEVEL(level, tag, fmt, ...) do {                       \
+        static log_ring_site_t _log_site;                               \
+        log_ring_write(&_log_site, level, tag, fmt, ##__VA_ARGS__);     \
+    } while (0)
+#define LOG_RING_E(tag, fmt, ...) LOG_RING_LEVEL(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_W(tag, fmt, ...) LOG_RING_LEVEL(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_I(tag, fmt, ...) LOG_RING_LEVEL(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_D(tag, fmt, ...) LOG_RING_LEVEL(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#else
+#define LOG_RING_E(tag, fmt, ...) ESP_LOGE(tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_W(tag, fmt, ...) ESP_LOGW(tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_I(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_D(tag, fmt, ...) ESP_LOGD(tag, fmt, ##__VA_ARGS__)
+#endif
@@ -0,0 +1,152 @@
+/*
+ * ESP32-CAM 效能設定檔 (Performance Profiles)
+ *
+ * 內建設定檔表與 NVS 持久化。
+ * 各設定檔的 FPS / 延遲 / 記憶體參考值請見 README.md。
+ */
+
+#include <string.h>
+#include <esp_log.h>
+#include <nvs_flash.h>
+#include <nvs.h>
+
+#include "perf_profile.h"
+
+static const char *TAG = "perf_profile";
+
+#define PROFILE_NVS_NAMESPACE   "perf"
+#define PROFILE_NVS_KEY         "profile"
+
+static const perf_profile_t s_profiles[] = {
+    {
+        // Maximum detail, matches the original firmware settings
+        .name = "high-resolution",
+        .frame_size = FRAMESIZE_UXGA,       // 1600x1200
+        .jpeg_quality = 12,
+        .fb_count = 3,
+        .grab_mode = CAMERA_GRAB_WHEN_EMPTY,
+        .xclk_freq_hz = 20000000,
+        .frame_interval_ms = 100,
+        .max_open_sockets = 4,
+        .max_streams = 1,
+    },
+    {
+        // Always send the newest frame, no pacing delay
+        .name = "low-latency",
+        .frame_size = FRAMESIZE_VGA,        // 640x480
+        .jpeg_quality = 12,
+        .fb_count = 2,
+        .grab_mode = CAMERA_GRAB_LATEST,
+        .xclk_freq_hz = 20000000,
+        .frame_interval_ms = 0,
+        .max_open_sockets = 3,
+        .max_streams = 1,
+    },
+    {
+        // Smaller frames and pacing so several clients share the link
+        .name = "many-viewers",
+        .frame_size = FRAMESIZE_SVGA,       // 800x600
+        .jpeg_quality = 15,
+        .fb_count = 3,
+        .grab_mode = CAMERA_GRAB_LATEST,
+        .xclk_freq_hz = 20000000,
+        .frame_interval_ms = 66,
+        .max_open_sockets = 7,              // LWIP_MAX_SOCKETS (10) - 3 internal
+        .max_streams = 4,
+    },
+    {
+        // Minimum clock, single buffer, slow refresh
+        .name = "low-power",
+        .frame_size = FRAMESIZE_QVGA,       // 320x240
+        .jpeg_quality = 15,
+        .fb_count = 1,
+        .grab_mode = CAMERA_GRAB_WHEN_EMPTY,
+        .xclk_freq_hz = 10000000,
+        .frame_interval_ms = 500,
+        .max_open_sockets = 3,
+        .max_streams = 1,
+    },
+};
+
+#define PROFILE_COUNT (sizeof(s_profiles) / sizeof(s_profiles[0]))
+
+size_t perf_profile_count(void)
+{
+    return PROFILE_COUNT;
+}
+
+const perf_profile_t *perf_profile_at(size_t index)
+{
+    return index < PROFILE_COUNT ? &s_profiles[index] : NULL;
+}
+
+const perf_profile_t *perf_profile_find(const char *name)
+{
+    if (name == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < PROFILE_COUNT; i++) {
+        if (strcmp(s_profiles[i].name, name) == 0) {
+            return &s_profiles[i];
+        }
+    }
+    return NULL;
+}
+
+const perf_profile_t *perf_profile_default(void)
+{
+#if defined(CONFIG_CAM_PROFILE_LOW_LATENCY)
+    return perf_profile_find("low-latency");
+#elif defined(CONFIG_CAM_PROFILE_MANY_VIEWERS)
+    return perf_profile_find("many-viewers");
+#elif defined(CONFIG_CAM_PROFILE_LOW_POWER)
+    return perf_profile_find("low-power");
+#else
+    return perf_profile_find("high-resolution");
+#endif
+}
+
+const perf_profile_t *perf_profile_load(void)
+{
+    nvs_handle_t handle;
+    char name[32];
+    size_t len = sizeof(name);
+    const perf_profile_t *profile = NULL;
+
+    if (nvs_open(PROFILE_NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        if (nvs_get_str(handle, PROFILE_NVS_KEY, name, &len) == ESP_OK) {
+            profile = perf_profile_find(name);
+            if (profile == NULL) {
+                ESP_LOGW(TAG, "Unknown profile '%s' in NVS, using default", name);
+            }
+        }
+        nvs_close(handle);
+    }
+
+    if (profile == NULL) {
+        profile = perf_profile_default();
+    }
+    ESP_LOGI(TAG, "Active profile: %s", profile->name);
+    return profile;
+}
+
+esp_err_t perf_profile_save(const perf_profile_t *profile)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(PROFILE_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = nvs_set_str(handle, PROFILE_NVS_KEY, profile->name);
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save profile: %s", esp_err_to_name(err));
+    }
+    return err;
+}
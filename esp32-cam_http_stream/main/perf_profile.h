@@ -0,0 +1,47 @@
+/*
+ * ESP32-CAM 效能設定檔 (Performance Profiles)
+ *
+ * 每個設定檔綁定一組相機與伺服器參數:
+ * - 解析度、JPEG 品質、frame buffer 數量、grab mode、XCLK
+ * - 串流節奏 (每幀最小間隔)
+ * - HTTP server socket 上限與同時串流數
+ *
+ * 預設設定檔由 Kconfig 選擇，執行期可透過 /profile 切換並存入 NVS。
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+
+typedef struct {
+    const char *name;
+    framesize_t frame_size;
+    int jpeg_quality;               // 0-63, lower = higher quality
+    size_t fb_count;
+    camera_grab_mode_t grab_mode;
+    int xclk_freq_hz;
+    uint32_t frame_interval_ms;     // Stream pacing, 0 = as fast as the sensor delivers
+    uint16_t max_open_sockets;      // httpd socket limit (applied when the server starts)
+    uint8_t max_streams;            // Concurrent /stream clients
+} perf_profile_t;
+
+// Number of built-in profiles
+size_t perf_profile_count(void);
+
+// Profile by index, NULL if out of range
+const perf_profile_t *perf_profile_at(size_t index);
+
+// Profile by name, NULL if unknown
+const perf_profile_t *perf_profile_find(const char *name);
+
+// Profile selected in menuconfig
+const perf_profile_t *perf_profile_default(void);
+
+// Profile stored in NVS, falls back to the Kconfig default
+const perf_profile_t *perf_profile_load(void);
+
+// Persist the profile name to NVS so it survives a reboot
+esp_err_t perf_profile_save(const perf_profile_t *profile);
@@ -0,0 +1,30 @@
+/*
+ * ESP32-CAM 感測器存取鎖 (Sensor Lock)
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "sensor_lock.h"
+
+static SemaphoreHandle_t s_lock = NULL;
+
+esp_err_t sensor_lock_init(void)
+{
+    s_lock = xSemaphoreCreateMutex();
+    return s_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void sensor_lock_take(void)
+{
+    if (s_lock) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+    }
+}
+
+void sensor_lock_give(void)
+{
+    if (s_lock) {
+        xSemaphoreGive(s_lock);
+    }
+}
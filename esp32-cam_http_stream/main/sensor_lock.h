@@ -0,0 +1,22 @@
+/*
+ * ESP32-CAM 感測器存取鎖 (Sensor Lock)
+ *
+ * - 切換設定檔時的 esp_camera_deinit() / esp_camera_init() 與感測器
+ *   暫存器存取 (SCCB) 共用同一把鎖
+ * - esp_camera_deinit() 會釋放 sensor_t，其他任務不可在此期間使用
+ *   先前取得的指標
+ * - OV2640 的 get_reg() / set_reg() 先以另一次寫入切換暫存器 bank，
+ *   兩個任務交錯存取時會讀寫到錯誤的 bank
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+// Create the lock (call before the camera is initialized)
+esp_err_t sensor_lock_init(void);
+
+// Hold while using esp_camera_sensor_get() or re-initializing the camera.
+// Fetch the sensor_t after taking the lock, it may change across a re-init.
+void sensor_lock_take(void);
+void sensor_lock_give(void);
@@ -0,0 +1,365 @@
+/*
+ * ESP32-CAM HTTPS 傳輸層 (TLS Server)
+ *
+ * 直接使用 mbedtls 而非 esp_https_server，才能在 session cache / ticket
+ * 回呼中得知這次握手是否為恢復 (resumption)，並精確量測握手時間。
+ * 握手在 httpd 任務的 open_fn 中依序進行，因此以單一旗標記錄即可。
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <nvs.h>
+#include <lwip/sockets.h>
+
+#include "esp_timer.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/net_sockets.h"
+
+#include "tls_server.h"
+
+static const char *TAG = "tls_server";
+
+#ifdef CONFIG_HTTPS_ENABLED
+
+#define TLS_NVS_NAMESPACE       "https"
+#define TLS_HANDSHAKE_TIMEOUT_US (10 * 1000 * 1000)
+
+typedef struct {
+    mbedtls_ssl_context ssl;
+    int fd;
+} tls_session_t;
+
+static mbedtls_entropy_context s_entropy;
+static mbedtls_ctr_drbg_context s_drbg;
+static mbedtls_ssl_config s_conf;
+static mbedtls_x509_crt s_cert;
+static mbedtls_pk_context s_key;
+#if defined(MBEDTLS_SSL_CACHE_C)
+static mbedtls_ssl_cache_context s_cache;
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+static mbedtls_ssl_ticket_context s_ticket;
+#endif
+
+static bool s_ready = false;
+static bool s_resumed = false;      // Set by the cache / ticket callbacks during a handshake
+static tls_server_stats_t s_stats;
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static int cache_get(void *data, unsigned char const *session_id, size_t session_id_len,
+                     mbedtls_ssl_session *session)
+{
+    int ret = mbedtls_ssl_cache_get(data, session_id, session_id_len, session);
+    if (ret == 0) {
+        s_resumed = true;
+    }
+    return ret;
+}
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+static int ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+                        unsigned char *buf, size_t len)
+{
+    int ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+    if (ret == 0) {
+        s_resumed = true;
+    }
+    return ret;
+}
+#endif
+
+static int bio_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    int ret = send(((tls_session_t *)ctx)->fd, buf, len, 0);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ?
+               MBEDTLS_ERR_SSL_WANT_WRITE : MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    return ret;
+}
+
+static int bio_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    int ret = recv(((tls_session_t *)ctx)->fd, buf, len, 0);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ?
+               MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return ret;
+}
+
+static int tls_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    tls_session_t *sess = httpd_sess_get_transport_ctx(hd, sockfd);
+    if (sess == NULL || buf == NULL) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+
+    int ret = mbedtls_ssl_write(&sess->ssl, (const unsigned char *)buf, buf_len);
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+        return HTTPD_SOCK_ERR_TIMEOUT;
+    }
+    return ret < 0 ? HTTPD_SOCK_ERR_FAIL : ret;
+}
+
+static int tls_recv(httpd_handle_t hd, int sockfd, char *buf, size_t buf_len, int flags)
+{
+    tls_session_t *sess = httpd_sess_get_transport_ctx(hd, sockfd);
+    if (sess == NULL || buf == NULL) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+
+    int ret = mbedtls_ssl_read(&sess->ssl, (unsigned char *)buf, buf_len);
+    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+        return 0;
+    }
+    if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+        return HTTPD_SOCK_ERR_TIMEOUT;
+    }
+    return ret < 0 ? HTTPD_SOCK_ERR_FAIL : ret;
+}
+
+static int tls_pending(httpd_handle_t hd, int sockfd)
+{
+    tls_session_t *sess = httpd_sess_get_transport_ctx(hd, sockfd);
+    return sess ? (int)mbedtls_ssl_get_bytes_avail(&sess->ssl) : 0;
+}
+
+static void tls_free(void *ctx)
+{
+    tls_session_t *sess = ctx;
+    mbedtls_ssl_free(&sess->ssl);
+    free(sess);
+}
+
+static void tls_close(httpd_handle_t hd, int sockfd)
+{
+    tls_session_t *sess = httpd_sess_get_transport_ctx(hd, sockfd);
+    if (sess != NULL) {
+        mbedtls_ssl_close_notify(&sess->ssl);
+    }
+    close(sockfd);
+}
+
+// Runs in the httpd task for every accepted connection
+static esp_err_t tls_open(httpd_handle_t hd, int sockfd)
+{
+    tls_session_t *sess = calloc(1, sizeof(tls_session_t));
+    if (sess == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    sess->fd = sockfd;
+    mbedtls_ssl_init(&sess->ssl);
+
+    int ret = mbedtls_ssl_setup(&sess->ssl, &s_conf);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "mbedtls_ssl_setup failed: -0x%x", -ret);
+        tls_free(sess);
+        return ESP_FAIL;
+    }
+    mbedtls_ssl_set_bio(&sess->ssl, sess, bio_send, bio_recv, NULL);
+
+    s_resumed = false;
+    int64_t start = esp_timer_get_time();
+    while ((ret = mbedtls_ssl_handshake(&sess->ssl)) != 0) {
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+            esp_timer_get_time() - start > TLS_HANDSHAKE_TIMEOUT_US) {
+            ESP_LOGW(TAG, "Handshake failed: -0x%x", -ret);
+            s_stats.failed_handshakes++;
+            tls_free(sess);
+            return ESP_FAIL;
+        }
+    }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    if (s_resumed) {
+        s_stats.resumed_handshakes++;
+        s_stats.resumed_total_us += elapsed;
+        s_stats.resumed_last_us = elapsed;
+    } else {
+        s_stats.full_handshakes++;
+        s_stats.full_total_us += elapsed;
+        s_stats.full_last_us = elapsed;
+    }
+    ESP_LOGD(TAG, "%s handshake: %lu us", s_resumed ? "Resumed" : "Full", (unsigned long)elapsed);
+
+    httpd_sess_set_transport_ctx(hd, sockfd, sess, tls_free);
+    httpd_sess_set_send_override(hd, sockfd, tls_send);
+    httpd_sess_set_recv_override(hd, sockfd, tls_recv);
+    httpd_sess_set_pending_override(hd, sockfd, tls_pending);
+    return ESP_OK;
+}
+
+// Read a PEM or DER blob from NVS, NUL-terminated so PEM parsing works
+static esp_err_t load_blob(nvs_handle_t handle, const char *key, unsigned char **out, size_t *out_len)
+{
+    size_t len = 0;
+    esp_err_t err = nvs_get_blob(handle, key, NULL, &len);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    unsigned char *buf = malloc(len + 1);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    err = nvs_get_blob(handle, key, buf, &len);
+    if (err != ESP_OK) {
+        free(buf);
+        return err;
+    }
+    buf[len] = '\0';
+
+    // PEM parsers expect the terminating NUL to be included in the length
+    *out_len = strstr((const char *)buf, "-----BEGIN") ? len + 1 : len;
+    *out = buf;
+    return ESP_OK;
+}
+
+static esp_err_t load_credentials(void)
+{
+    nvs_handle_t handle;
+    unsigned char *cert = NULL;
+    unsigned char *key = NULL;
+    size_t cert_len = 0;
+    size_t key_len = 0;
+
+    esp_err_t err = nvs_open(TLS_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    err = load_blob(handle, "cert", &cert, &cert_len);
+    if (err == ESP_OK) {
+        err = load_blob(handle, "key", &key, &key_len);
+    }
+    nvs_close(handle);
+    if (err != ESP_OK) {
+        free(cert);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int ret = mbedtls_x509_crt_parse(&s_cert, cert, cert_len);
+    if (ret == 0) {
+        ret = mbedtls_pk_parse_key(&s_key, key, key_len, NULL, 0,
+                                   mbedtls_ctr_drbg_random, &s_drbg);
+    }
+
+    // Wipe the private key copy before releasing it
+    memset(key, 0, key_len);
+    free(key);
+    free(cert);
+
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to parse certificate or key: -0x%x", -ret);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t tls_server_init(void)
+{
+    mbedtls_entropy_init(&s_entropy);
+    mbedtls_ctr_drbg_init(&s_drbg);
+    mbedtls_ssl_config_init(&s_conf);
+    mbedtls_x509_crt_init(&s_cert);
+    mbedtls_pk_init(&s_key);
+
+    int ret = mbedtls_ctr_drbg_seed(&s_drbg, mbedtls_entropy_func, &s_entropy, NULL, 0);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "DRBG seed failed: -0x%x", -ret);
+        return ESP_FAIL;
+    }
+
+    esp_err_t err = load_credentials();
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "No certificate in NVS (namespace '%s'), HTTPS disabled", TLS_NVS_NAMESPACE);
+        return err;
+    } else if (err != ESP_OK) {
+        return err;
+    }
+
+    ret = mbedtls_ssl_config_defaults(&s_conf, MBEDTLS_SSL_IS_SERVER,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret == 0) {
+        ret = mbedtls_ssl_conf_own_cert(&s_conf, &s_cert, &s_key);
+    }
+    if (ret != 0) {
+        ESP_LOGE(TAG, "TLS config failed: -0x%x", -ret);
+        return ESP_FAIL;
+    }
+    mbedtls_ssl_conf_rng(&s_conf, mbedtls_ctr_drbg_random, &s_drbg);
+
+    // TLS 1.2 keeps both resumption mechanisms observable through the callbacks
+    mbedtls_ssl_conf_max_tls_version(&s_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_init(&s_cache);
+    mbedtls_ssl_cache_set_max_entries(&s_cache, CONFIG_HTTPS_SESSION_CACHE_SIZE);
+    mbedtls_ssl_cache_set_timeout(&s_cache, CONFIG_HTTPS_SESSION_LIFETIME_S);
+    mbedtls_ssl_conf_session_cache(&s_conf, &s_cache, cache_get, mbedtls_ssl_cache_set);
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(CONFIG_HTTPS_SESSION_TICKETS)
+    mbedtls_ssl_ticket_init(&s_ticket);
+    ret = mbedtls_ssl_ticket_setup(&s_ticket, mbedtls_ctr_drbg_random, &s_drbg,
+                                   MBEDTLS_CIPHER_AES_256_GCM, CONFIG_HTTPS_SESSION_LIFETIME_S);
+    if (ret == 0) {
+        mbedtls_ssl_conf_session_tickets_cb(&s_conf, mbedtls_ssl_ticket_write, ticket_parse, &s_ticket);
+    } else {
+        ESP_LOGW(TAG, "Session tickets unavailable: -0x%x", -ret);
+    }
+#endif
+
+    s_ready = true;
+    ESP_LOGI(TAG, "HTTPS ready on port %d", CONFIG_HTTPS_PORT);
+    return ESP_OK;
+}
+
+bool tls_server_ready(void)
+{
+    return s_ready;
+}
+
+void tls_server_configure(httpd_config_t *config)
+{
+    config->server_port = CONFIG_HTTPS_PORT;
+    config->open_fn = tls_open;
+    config->close_fn = tls_close;
+}
+
+void tls_server_get_stats(tls_server_stats_t *stats)
+{
+    *stats = s_stats;
+}
+
+#else  // CONFIG_HTTPS_ENABLED
+
+esp_err_t tls_server_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool tls_server_ready(void)
+{
+    return false;
+}
+
+void tls_server_configure(httpd_config_t *config)
+{
+}
+
+void tls_server_get_stats(tls_server_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif  // CONFIG_HTTPS_ENABLED
@@ -0,0 +1,37 @@
+/*
+ * ESP32-CAM HTTPS 傳輸層 (TLS Server)
+ *
+ * - 以 httpd 的 open_fn / send / recv override 在同一個 HTTP server 上提供 TLS
+ * - 支援 session ticket 與 session ID cache，回訪客戶端可略過非對稱加密運算
+ * - 憑證與私鑰由 NVS 讀取 (namespace "https"，key "cert" / "key")
+ * - 統計握手次數、恢復命中率與握手時間
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+typedef struct {
+    uint32_t full_handshakes;       // Handshakes with full key exchange
+    uint32_t resumed_handshakes;    // Handshakes resumed from a ticket or cached session
+    uint32_t failed_handshakes;
+    uint64_t full_total_us;
+    uint64_t resumed_total_us;
+    uint32_t full_last_us;
+    uint32_t resumed_last_us;
+} tls_server_stats_t;
+
+// Load certificate and key from NVS and prepare the TLS configuration
+// Returns ESP_ERR_NOT_FOUND when no credentials are provisioned.
+esp_err_t tls_server_init(void);
+
+// True once tls_server_init() succeeded
+bool tls_server_ready(void);
+
+// Install the TLS transport hooks and HTTPS port into an httpd configuration
+void tls_server_configure(httpd_config_t *config);
+
+void tls_server_get_stats(tls_server_stats_t *stats);
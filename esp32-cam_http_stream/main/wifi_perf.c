@@ -0,0 +1,185 @@
+/*
+ * ESP32-CAM WiFi 效能設定與量測 (Wi-Fi Performance)
+ *
+ * ESP-IDF 沒有公開目前 PHY 速率與 MAC 層重試次數的 API，因此以協商的
+ * PHY 模式 (HT20/HT40) 與 lwIP 的 TCP 重傳計數 (需啟用 LWIP_STATS) 代替。
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/param.h>
+#include <esp_log.h>
+
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "lwip/stats.h"
+
+#include "wifi_perf.h"
+
+static const char *TAG = "wifi_perf";
+
+#define BENCH_CHUNK_SIZE        4096
+#define BITRATE_PERIOD_US       (1000 * 1000)
+
+static uint8_t s_bench_buf[BENCH_CHUNK_SIZE];
+static uint32_t s_bench_bytes = 0;
+static uint32_t s_bench_kbps = 0;
+
+static atomic_uint s_stream_bytes = 0;
+static uint32_t s_stream_last = 0;
+static int64_t s_stream_last_us = 0;
+static uint32_t s_stream_bps = 0;
+static esp_timer_handle_t s_timer = NULL;
+
+static void bitrate_update(void *arg)
+{
+    uint32_t total = atomic_load(&s_stream_bytes);
+    int64_t now = esp_timer_get_time();
+    if (s_stream_last_us > 0) {
+        s_stream_bps = (uint32_t)((uint64_t)(total - s_stream_last) * 8 * 1000000 / (now - s_stream_last_us));
+    }
+    s_stream_last = total;
+    s_stream_last_us = now;
+}
+
+// TX power can only be set once the driver is started
+static void wifi_start_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+#if CONFIG_WIFI_PERF_TX_POWER_DBM > 0
+    // Unit is 0.25 dBm, the driver accepts 8 (2 dBm) to 84 (21 dBm)
+    esp_err_t err = esp_wifi_set_max_tx_power(MAX(CONFIG_WIFI_PERF_TX_POWER_DBM * 4, 8));
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set TX power: %s", esp_err_to_name(err));
+    }
+#endif
+}
+
+esp_err_t wifi_perf_init(void)
+{
+#if defined(CONFIG_WIFI_PERF_PS_NONE)
+    esp_wifi_set_ps(WIFI_PS_NONE);
+#elif defined(CONFIG_WIFI_PERF_PS_MAX_MODEM)
+    esp_wifi_set_ps(WIFI_PS_MAX_MODEM);
+#else
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+#endif
+
+#ifdef CONFIG_WIFI_PERF_HT40
+    esp_wifi_set_bandwidth(WIFI_IF_STA, WIFI_BW_HT40);
+#else
+    esp_wifi_set_bandwidth(WIFI_IF_STA, WIFI_BW_HT20);
+#endif
+
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_START, &wifi_start_handler, NULL);
+
+    // Printable pattern, easy to check on the client side
+    for (int i = 0; i < BENCH_CHUNK_SIZE; i++) {
+        s_bench_buf[i] = 'A' + i % 26;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = &bitrate_update,
+        .name = "wifi_perf"
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &s_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(s_timer, BITRATE_PERIOD_US);
+    }
+    return err;
+}
+
+void wifi_perf_stream_bytes(size_t bytes)
+{
+    atomic_fetch_add(&s_stream_bytes, bytes);
+}
+
+esp_err_t wifi_perf_bench_send(httpd_req_t *req, uint32_t bytes)
+{
+    esp_err_t res = ESP_OK;
+    uint32_t sent = 0;
+
+    httpd_resp_set_type(req, "application/octet-stream");
+
+    int64_t start = esp_timer_get_time();
+    while (sent < bytes && res == ESP_OK) {
+        size_t len = MIN(bytes - sent, BENCH_CHUNK_SIZE);
+        res = httpd_resp_send_chunk(req, (const char *)s_bench_buf, len);
+        sent += len;
+    }
+    if (res == ESP_OK) {
+        res = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    if (res != ESP_OK) {
+        ESP_LOGW(TAG, "Net bench aborted after %lu bytes", (unsigned long)sent);
+        return res;
+    }
+
+    // The last send buffer's worth is still in flight, negligible for large payloads
+    s_bench_bytes = bytes;
+    s_bench_kbps = elapsed > 0 ? (uint32_t)((uint64_t)bytes * 8000 / elapsed) : 0;
+    ESP_LOGI(TAG, "Net bench: %lu bytes in %lu ms, %lu kbps",
+             (unsigned long)bytes, (unsigned long)(elapsed / 1000), (unsigned long)s_bench_kbps);
+    return ESP_OK;
+}
+
+static const char *phy_mode_name(wifi_phy_mode_t mode)
+{
+    switch (mode) {
+    case WIFI_PHY_MODE_LR:   return "LR";
+    case WIFI_PHY_MODE_11B:  return "11b";
+    case WIFI_PHY_MODE_11G:  return "11g";
+    case WIFI_PHY_MODE_HT20: return "HT20";
+    case WIFI_PHY_MODE_HT40: return "HT40";
+    default:                 return "unknown";
+    }
+}
+
+static const char *ps_name(wifi_ps_type_t ps)
+{
+    switch (ps) {
+    case WIFI_PS_NONE:      return "none";
+    case WIFI_PS_MIN_MODEM: return "min_modem";
+    case WIFI_PS_MAX_MODEM: return "max_modem";
+    default:                return "unknown";
+    }
+}
+
+void wifi_perf_get_stats(wifi_perf_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->phy = "none";
+
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        stats->rssi = ap.rssi;
+        stats->channel = ap.primary;
+        wifi_phy_mode_t mode;
+        if (esp_wifi_sta_get_negotiated_phymode(&mode) == ESP_OK) {
+            stats->phy = phy_mode_name(mode);
+        }
+    }
+
+    wifi_bandwidth_t bw = WIFI_BW_HT20;
+    esp_wifi_get_bandwidth(WIFI_IF_STA, &bw);
+    stats->bandwidth = bw == WIFI_BW_HT40 ? "HT40" : "HT20";
+
+    wifi_ps_type_t ps = WIFI_PS_NONE;
+    esp_wifi_get_ps(&ps);
+    stats->ps = ps_name(ps);
+
+    int8_t power = 0;
+    if (esp_wifi_get_max_tx_power(&power) == ESP_OK) {
+        stats->tx_power_dbm = power / 4.0f;
+    }
+
+    stats->stream_bps = s_stream_bps;
+#if LWIP_STATS && TCP_STATS
+    stats->tcp_xmit = lwip_stats.tcp.xmit;
+    stats->tcp_rexmit = lwip_stats.tcp.rexmit;
+#endif
+    stats->bench_bytes = s_bench_bytes;
+    stats->bench_kbps = s_bench_kbps;
+}
@@ -0,0 +1,39 @@
+/*
+ * ESP32-CAM WiFi 效能設定與量測 (Wi-Fi Performance)
+ *
+ * - 啟動時套用 menuconfig 設定: 省電模式、HT40 頻寬、最大發射功率
+ * - /bench/net?bytes=N 從靜態緩衝區送出合成資料，不經過相機即可量測
+ *   TCP 可達吞吐量
+ * - /status 顯示 RSSI、頻道、協商的 PHY 模式、TCP 重傳與串流位元率
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+typedef struct {
+    int8_t rssi;                // dBm, 0 when not associated
+    uint8_t channel;
+    const char *phy;            // Negotiated PHY mode, e.g. "HT20"
+    const char *bandwidth;      // Configured bandwidth
+    const char *ps;             // Current power save mode
+    float tx_power_dbm;         // Maximum TX power
+    uint32_t stream_bps;        // Stream payload bitrate over the last second
+    uint32_t tcp_xmit;          // TCP segments sent (0 without LWIP_STATS)
+    uint32_t tcp_rexmit;        // TCP segments retransmitted (0 without LWIP_STATS)
+    uint32_t bench_bytes;       // Last /bench/net payload
+    uint32_t bench_kbps;        // Last /bench/net throughput
+} wifi_perf_stats_t;
+
+// Apply power save and bandwidth (call after esp_wifi_set_mode, before esp_wifi_start)
+esp_err_t wifi_perf_init(void);
+
+// Account payload bytes sent by a stream
+void wifi_perf_stream_bytes(size_t bytes);
+
+// Send bytes of synthetic payload as the response body
+esp_err_t wifi_perf_bench_send(httpd_req_t *req, uint32_t bytes);
+
+void wifi_perf_get_stats(wifi_perf_stats_t *stats);
@@ -0,0 +1,478 @@
+#!/usr/bin/env python3
+"""
+ESP32-CAM MJPEG multi-client load generator
+
+Connects N MJPEG consumers to /stream and reports per-client fps, jitter,
+capture-to-client latency percentiles and X-Frame-Seq gaps.
+
+Latency is computed from the X-Timestamp header, which is only meaningful
+when the device clock is SNTP-synchronized ("time_synced": true in /status)
+and this host is NTP-synchronized too.
+
+--profiles switches the device through performance profiles (/profile),
+measures each one and prints the README benchmark table with the test
+conditions. Memory columns come from heap_free / psram_free in /status.
+
+Usage:
+    python mjpeg_loadgen.py http://192.168.1.100/stream -n 4 -d 30 -u hsieh:1395
+    python mjpeg_loadgen.py http://192.168.1.100/stream -d 30 -u hsieh:1395 --profiles all
+    python mjpeg_loadgen.py --mock -n 4 -d 10          # local mock server
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import base64
+import http.client
+import http.server
+import json
+import os
+import socketserver
+import ssl
+import statistics
+import threading
+import time
+import urllib.parse
+
+BOUNDARY = "123456789000000000000987654321"
+
+
+class ClientStats:
+    def __init__(self, index):
+        self.index = index
+        self.frames = 0
+        self.bytes = 0
+        self.arrivals = []
+        self.latencies_ms = []
+        self.seq_gaps = 0
+        self.last_seq = None
+        self.error = None
+
+    def add_frame(self, arrival, size, timestamp, seq):
+        self.frames += 1
+        self.bytes += size
+        self.arrivals.append(arrival)
+        # Unix time (> 2001) means the device clock is SNTP-synchronized
+        if timestamp is not None and timestamp > 1e9:
+            self.latencies_ms.append((arrival - timestamp) * 1000.0)
+        if seq is not None:
+            if self.last_seq is not None and seq > self.last_seq + 1:
+                self.seq_gaps += seq - self.last_seq - 1
+            self.last_seq = seq
+
+    def summary(self):
+        elapsed = self.arrivals[-1] - self.arrivals[0] if len(self.arrivals) > 1 else 0
+        intervals = [(b - a) * 1000.0 for a, b in zip(self.arrivals, self.arrivals[1:])]
+        return {
+            "client": self.index,
+            "frames": self.frames,
+            "fps": (self.frames - 1) / elapsed if elapsed > 0 else 0.0,
+            "kbps": self.bytes * 8 / 1000.0 / elapsed if elapsed > 0 else 0.0,
+            "jitter_ms": statistics.pstdev(intervals) if len(intervals) > 1 else 0.0,
+            "latency_p50_ms": percentile(self.latencies_ms, 50),
+            "latency_p95_ms": percentile(self.latencies_ms, 95),
+            "latency_p99_ms": percentile(self.latencies_ms, 99),
+            "seq_gaps": self.seq_gaps,
+            "error": self.error,
+        }
+
+
+def percentile(values, pct):
+    if not values:
+        return None
+    ordered = sorted(values)
+    k = (len(ordered) - 1) * pct / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(ordered) - 1)
+    return ordered[lo] + (ordered[hi] - ordered[lo]) * (k - lo)
+
+
+def read_part(resp, boundary):
+    """Read one multipart part, returns (headers, body) or None at end of stream."""
+    marker = b"--" + boundary.encode()
+
+    # Skip to the boundary line
+    while True:
+        line = resp.readline()
+        if not line:
+            return None
+        if line.strip() == marker:
+            break
+
+    headers = {}
+    while True:
+        line = resp.readline()
+        if not line:
+            return None
+        line = line.strip()
+        if not line:
+            break
+        key, _, value = line.decode("latin-1").partition(":")
+        headers[key.strip().lower()] = value.strip()
+
+    if "content-length" in headers:
+        return headers, resp.read(int(headers["content-length"]))
+
+    # No Content-Length: body runs until the next boundary
+    body = bytearray()
+    while True:
+        line = resp.readline()
+        if not line:
+            return None
+        if line.strip() == marker:
+            # Put the boundary back for the next call by returning early
+            resp.pending_boundary = True
+            break
+        body += line
+    if body.endswith(b"\r\n"):
+        body = body[:-2]
+    return headers, bytes(body)
+
+
+class PartReader:
+    """Wraps an HTTPResponse so a consumed boundary line can be replayed."""
+
+    def __init__(self, resp, boundary):
+        self.resp = resp
+        self.boundary = boundary
+        self.pending_boundary = False
+
+    def readline(self):
+        if self.pending_boundary:
+            self.pending_boundary = False
+            return b"--" + self.boundary.encode() + b"\r\n"
+        return self.resp.readline()
+
+    def read(self, n):
+        return self.resp.read(n)
+
+
+def run_client(index, url, auth, duration, stats):
+    parsed = urllib.parse.urlparse(url)
+    if parsed.scheme == "https":
+        # The device usually has a self-signed certificate
+        conn = http.client.HTTPSConnection(parsed.hostname, parsed.port, timeout=10,
+                                           context=ssl._create_unverified_context())
+    else:
+        conn = http.client.HTTPConnection(parsed.hostname, parsed.port, timeout=10)
+    headers = {}
+    if auth:
+        headers["Authorization"] = "Basic " + base64.b64encode(auth.encode()).decode()
+
+    try:
+        path = parsed.path or "/stream"
+        if parsed.query:
+            path += "?" + parsed.query
+        conn.request("GET", path, headers=headers)
+        resp = conn.getresponse()
+        if resp.status != 200:
+            stats.error = "HTTP %d" % resp.status
+            return
+
+        content_type = resp.getheader("Content-Type", "")
+        boundary = content_type.split("boundary=")[-1] if "boundary=" in content_type else BOUNDARY
+        reader = PartReader(resp, boundary)
+        deadline = time.time() + duration
+
+        while time.time() < deadline:
+            part = read_part(reader, boundary)
+            if part is None:
+                stats.error = "stream ended"
+                break
+            part_headers, body = part
+            arrival = time.time()
+            timestamp = part_headers.get("x-timestamp")
+            seq = part_headers.get("x-frame-seq")
+            stats.add_frame(arrival, len(body),
+                            float(timestamp) if timestamp else None,
+                            int(seq) if seq else None)
+    except (OSError, http.client.HTTPException) as exc:
+        stats.error = str(exc)
+    finally:
+        conn.close()
+
+
+class MockCamera:
+    """Produces frame sequence numbers at a fixed rate, like the sensor does."""
+
+    PROFILES = ["high-resolution", "low-latency", "many-viewers", "low-power"]
+
+    def __init__(self, jpeg, fps):
+        self.jpeg = jpeg
+        self.profile = self.PROFILES[0]
+        self.interval = 1.0 / fps
+        self.seq = 0
+        self.timestamp = time.time()
+        self.streams = 0
+        self.cond = threading.Condition()
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def _run(self):
+        while True:
+            time.sleep(self.interval)
+            with self.cond:
+                self.seq += 1
+                self.timestamp = time.time()
+                self.cond.notify_all()
+
+    def wait_frame(self, last_seq):
+        with self.cond:
+            self.cond.wait_for(lambda: self.seq != last_seq, timeout=1.0)
+            return self.seq, self.timestamp
+
+
+def make_mock_handler(camera):
+    class MockHandler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt, *args):
+            pass
+
+        def do_GET(self):
+            if self.path.startswith("/stream"):
+                self.send_response(200)
+                self.send_header("Content-Type", "multipart/x-mixed-replace;boundary=" + BOUNDARY)
+                self.send_header("Connection", "close")
+                self.end_headers()
+                seq = -1
+                # Like the device, a disconnect is only noticed on the next write
+                with camera.cond:
+                    camera.streams += 1
+                try:
+                    while True:
+                        seq, timestamp = camera.wait_frame(seq)
+                        part = ("--%s\r\nContent-Type: image/jpeg\r\nContent-Length: %d\r\n"
+                                "X-Timestamp: %.6f\r\nX-Frame-Seq: %d\r\n\r\n"
+                                % (BOUNDARY, len(camera.jpeg), timestamp, seq)).encode()
+                        self.wfile.write(part + camera.jpeg + b"\r\n")
+                except (BrokenPipeError, ConnectionResetError):
+                    pass
+                finally:
+                    with camera.cond:
+                        camera.streams -= 1
+            elif self.path.startswith("/status"):
+                self.send_json({"profile": camera.profile, "streams": camera.streams, "time_synced": True,
+                                "heap_free": 0, "heap_min_free": 0, "psram_free": 0, "psram_total": 0})
+            elif self.path.startswith("/profile"):
+                query = urllib.parse.parse_qs(urllib.parse.urlparse(self.path).query)
+                if "name" in query:
+                    if query["name"][0] not in camera.PROFILES:
+                        self.send_error(400)
+                        return
+                    if camera.streams > 0:
+                        self.send_error(409)
+                        return
+                    camera.profile = query["name"][0]
+                self.send_json({"active": camera.profile,
+                                "profiles": [{"name": name} for name in camera.PROFILES]})
+            elif self.path.startswith("/capture"):
+                seq, timestamp = camera.wait_frame(camera.seq)
+                self.send_response(200)
+                self.send_header("Content-Type", "image/jpeg")
+                self.send_header("Content-Length", str(len(camera.jpeg)))
+                self.send_header("X-Timestamp", "%.6f" % timestamp)
+                self.send_header("X-Frame-Seq", str(seq))
+                self.end_headers()
+                self.wfile.write(camera.jpeg)
+            else:
+                self.send_error(404)
+
+        def send_json(self, obj):
+            body = json.dumps(obj).encode()
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+    return MockHandler
+
+
+def start_mock_server(port, fps, jpeg_path):
+    with open(jpeg_path, "rb") as f:
+        jpeg = f.read()
+    server = socketserver.ThreadingTCPServer(("127.0.0.1", port), make_mock_handler(MockCamera(jpeg, fps)))
+    server.daemon_threads = True
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return "http://127.0.0.1:%d/stream" % server.server_address[1]
+
+
+def fmt(value, spec="%.1f"):
+    return "-" if value is None else spec % value
+
+
+class HTTPStatusError(RuntimeError):
+    def __init__(self, path, status, body):
+        super().__init__("%s: HTTP %d %s" % (path, status, body))
+        self.status = status
+
+
+def get_json(url, path, auth):
+    """GET a JSON endpoint on the same host as the stream URL."""
+    parsed = urllib.parse.urlparse(url)
+    if parsed.scheme == "https":
+        conn = http.client.HTTPSConnection(parsed.hostname, parsed.port, timeout=30,
+                                           context=ssl._create_unverified_context())
+    else:
+        conn = http.client.HTTPConnection(parsed.hostname, parsed.port, timeout=30)
+    headers = {}
+    if auth:
+        headers["Authorization"] = "Basic " + base64.b64encode(auth.encode()).decode()
+    try:
+        conn.request("GET", path, headers=headers)
+        resp = conn.getresponse()
+        body = resp.read()
+        if resp.status != 200:
+            raise HTTPStatusError(path, resp.status, body.decode(errors="replace"))
+        return json.loads(body)
+    finally:
+        conn.close()
+
+
+def run_clients(url, clients, auth, duration):
+    stats = [ClientStats(i) for i in range(clients)]
+    threads = [threading.Thread(target=run_client, args=(i, url, auth, duration, stats[i]))
+               for i in range(clients)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return stats
+
+
+def switch_profile(url, name, auth, timeout=10.0):
+    """Switch profile once the device has noticed every stream client is gone.
+
+    A stream worker only sees a disconnect on its next send, up to one pacing
+    interval later, and /profile answers 409 until then.
+    """
+    deadline = time.time() + timeout
+    while True:
+        try:
+            if get_json(url, "/status", auth).get("streams", 0) == 0:
+                return get_json(url, "/profile?name=" + urllib.parse.quote(name), auth)
+        except HTTPStatusError as e:
+            if e.status != 409:
+                raise
+        if time.time() >= deadline:
+            raise RuntimeError("profile %s: streams still active after %.0f s" % (name, timeout))
+        time.sleep(0.2)
+
+
+def run_profiles(url, names, clients, auth, duration, settle):
+    """Measure each profile in turn, returns (rows, conditions)."""
+    listing = get_json(url, "/profile", auth)
+    original = listing["active"]
+    if names == ["all"]:
+        names = [p["name"] for p in listing["profiles"]]
+
+    rows = []
+    try:
+        for name in names:
+            switch_profile(url, name, auth)
+            time.sleep(settle)
+            before = get_json(url, "/status", auth)
+            stats = run_clients(url, clients, auth, duration)
+            after = get_json(url, "/status", auth)
+
+            results = [s.summary() for s in stats]
+            latencies = [v for s in stats for v in s.latencies_ms]
+            errors = [r["error"] for r in results if r["error"]]
+            rows.append({
+                "profile": name,
+                "fps": sum(r["fps"] for r in results) / len(results),
+                "total_fps": sum(r["fps"] for r in results),
+                "kbps": sum(r["kbps"] for r in results),
+                "latency_p50_ms": percentile(latencies, 50),
+                "latency_p95_ms": percentile(latencies, 95),
+                "seq_gaps": sum(r["seq_gaps"] for r in results),
+                "psram_used_kb": (before["psram_total"] - before["psram_free"]) / 1024.0,
+                "heap_free_kb": before["heap_free"] / 1024.0,
+                "heap_min_free_kb": after["heap_min_free"] / 1024.0,
+                "time_synced": after.get("time_synced", False),
+                "rssi": after.get("rssi"),
+                "error": errors[0] if errors else None,
+            })
+    finally:
+        switch_profile(url, original, auth)
+
+    conditions = {
+        "date": time.strftime("%Y-%m-%d"),
+        "url": url,
+        "clients": clients,
+        "duration_s": duration,
+        "rssi": next((r["rssi"] for r in rows if r["rssi"] is not None), None),
+    }
+    return rows, conditions
+
+
+def print_profile_table(rows, conditions):
+    print("測試條件: %s，%s，%d 個客戶端，每個設定檔 %.0f 秒，RSSI %s dBm"
+          % (conditions["date"], conditions["url"], conditions["clients"],
+             conditions["duration_s"], fmt(conditions["rssi"], "%d")))
+    print()
+    print("| 設定檔 | FPS / 客戶端 | 總 FPS | 頻寬 (kbps) | 延遲 p50 | 延遲 p95 | 序號缺口 | PSRAM 使用 | 內部 heap 剩餘 (最低) |")
+    print("|--------|--------------|--------|-------------|----------|----------|----------|------------|------------------------|")
+    for r in rows:
+        print("| %s | %.1f | %.1f | %.0f | %s ms | %s ms | %d | %.0f KB | %.0f KB (%.0f KB) |%s"
+              % (r["profile"], r["fps"], r["total_fps"], r["kbps"],
+                 fmt(r["latency_p50_ms"], "%.0f") if r["time_synced"] else "-",
+                 fmt(r["latency_p95_ms"], "%.0f") if r["time_synced"] else "-",
+                 r["seq_gaps"], r["psram_used_kb"], r["heap_free_kb"], r["heap_min_free_kb"],
+                 "  <!-- %s -->" % r["error"] if r["error"] else ""))
+
+
+def main():
+    default_jpeg = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "test_capture.jpg")
+
+    parser = argparse.ArgumentParser(description="ESP32-CAM MJPEG multi-client load generator")
+    parser.add_argument("url", nargs="?", help="Stream URL, e.g. http://192.168.1.100/stream")
+    parser.add_argument("-n", "--clients", type=int, default=1, help="Number of concurrent consumers")
+    parser.add_argument("-d", "--duration", type=float, default=10.0, help="Test duration in seconds")
+    parser.add_argument("-u", "--auth", help="Basic auth credentials user:password")
+    parser.add_argument("--mock", action="store_true", help="Run against a local mock server")
+    parser.add_argument("--mock-port", type=int, default=0, help="Mock server port (0 = any)")
+    parser.add_argument("--mock-fps", type=float, default=25.0, help="Mock sensor frame rate")
+    parser.add_argument("--mock-jpeg", default=default_jpeg, help="JPEG served by the mock server")
+    parser.add_argument("--json", action="store_true", help="Print results as JSON")
+    parser.add_argument("--profiles", help="Measure these profiles (comma separated, or 'all') "
+                                           "and print the README benchmark table")
+    parser.add_argument("--settle", type=float, default=3.0, help="Seconds to wait after a profile switch")
+    args = parser.parse_args()
+
+    url = args.url
+    if args.mock:
+        url = start_mock_server(args.mock_port, args.mock_fps, args.mock_jpeg)
+    if not url:
+        parser.error("url is required unless --mock is given")
+
+    if args.profiles:
+        rows, conditions = run_profiles(url, args.profiles.split(","), args.clients,
+                                        args.auth, args.duration, args.settle)
+        if args.json:
+            print(json.dumps({"conditions": conditions, "profiles": rows}, indent=2))
+        else:
+            print_profile_table(rows, conditions)
+        return
+
+    stats = run_clients(url, args.clients, args.auth, args.duration)
+
+    results = [s.summary() for s in stats]
+    if args.json:
+        print(json.dumps(results, indent=2))
+        return
+
+    print("Target: %s  clients: %d  duration: %.0fs" % (url, args.clients, args.duration))
+    print("%-6s %7s %7s %9s %9s %9s %9s %9s %6s  %s"
+          % ("client", "frames", "fps", "kbps", "jitter", "lat p50", "lat p95", "lat p99", "gaps", "error"))
+    for r in results:
+        print("%-6d %7d %7.2f %9.0f %7.1fms %7sms %7sms %7sms %6d  %s"
+              % (r["client"], r["frames"], r["fps"], r["kbps"], r["jitter_ms"],
+                 fmt(r["latency_p50_ms"]), fmt(r["latency_p95_ms"]), fmt(r["latency_p99_ms"]),
+                 r["seq_gaps"], r["error"] or ""))
+    total_fps = sum(r["fps"] for r in results)
+    print("total fps: %.2f" % total_fps)
+
+
+if __name__ == "__main__":
+    main()